@@ -0,0 +1,42 @@
+// alloc.cpp : compares the heap allocator with the pool allocator and with the arena
+//
+#include "bench.h"
+#include "../imtjson/json.h"
+
+using namespace json;
+
+static Value buildDocument(std::size_t idx) {
+	Array items;
+	for (std::size_t i = 0; i < 16; i++) {
+		items.push_back(Object({
+				{"id", idx * 16 + i},
+				{"name", std::to_string(i)},
+				{"price", i * 0.25},
+				{"tags", {"a","b"}}}));
+	}
+	return Object({{"index", idx},{"items", items}});
+}
+
+static bench::Register allocBench("alloc", "building and dropping small documents, heap vs. pool vs. arena", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20000;
+	const Allocator *allocators[] = {Allocator::getHeap(), Allocator::getPool()};
+	const char *names[] = {"heap", "pool"};
+	for (int i = 0; i < 2; i++) {
+		Value::allocator = allocators[i];
+		double r = bench::measure(params.threads, iterations, [](std::size_t idx){
+			Value v = buildDocument(idx);
+			bench::keep(v);
+		});
+		out << names[i] << ": " << static_cast<std::size_t>(r) << " documents/s" << std::endl;
+	}
+	Value::allocator = Allocator::getPool();
+	//one arena holds a batch of documents, so the cost of its chunks is shared
+	const std::size_t batch = 16;
+	double r = bench::measure(params.threads, iterations / batch, [&](std::size_t idx){
+		std::vector<Value> docs;
+		ArenaScope scope(Arena::create());
+		for (std::size_t i = 0; i < batch; i++) docs.push_back(buildDocument(idx * batch + i));
+		bench::keep(docs.size());
+	});
+	out << "arena: " << static_cast<std::size_t>(r * batch) << " documents/s" << std::endl;
+});
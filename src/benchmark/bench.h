@@ -0,0 +1,80 @@
+/*
+ * bench.h
+ *
+ * Simple framework for benchmarks
+ */
+
+#ifndef SRC_BENCHMARK_BENCH_H_
+#define SRC_BENCHMARK_BENCH_H_
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+	///Parameters of the benchmark run
+	struct Params {
+		///count of threads
+		unsigned int threads;
+		///count of iterations per thread
+		std::size_t iterations;
+	};
+
+	typedef std::function<void(std::ostream &out, const Params &params)> BenchFn;
+
+	struct Benchmark {
+		const char *name;
+		const char *description;
+		BenchFn fn;
+	};
+
+	///List of registered benchmarks
+	inline std::vector<Benchmark> &registry() {
+		static std::vector<Benchmark> list;
+		return list;
+	}
+
+	///Registers benchmark - declare as static global object
+	class Register {
+	public:
+		Register(const char *name, const char *description, BenchFn fn) {
+			registry().push_back(Benchmark{name, description, std::move(fn)});
+		}
+	};
+
+	///Runs function in the threads and measures time
+	/**
+	 * @param threads count of threads
+	 * @param iterations count of iterations per thread
+	 * @param fn function called for every iteration. It receives index of the iteration
+	 * @return total count of iterations per second
+	 */
+	template<typename Fn>
+	double measure(unsigned int threads, std::size_t iterations, const Fn &fn) {
+		std::vector<std::thread> thrs;
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < threads; i++) {
+			thrs.push_back(std::thread([&]{
+				for (std::size_t j = 0; j < iterations; j++) fn(j);
+			}));
+		}
+		for (auto &t: thrs) t.join();
+		auto end = std::chrono::steady_clock::now();
+		double secs = std::chrono::duration<double>(end - start).count();
+		return static_cast<double>(threads) * static_cast<double>(iterations) / secs;
+	}
+
+	///Prevents the compiler to optimize out the result
+	template<typename T>
+	void keep(const T &val) {
+		asm volatile("" : : "g"(&val) : "memory");
+	}
+
+}
+
+
+
+#endif /* SRC_BENCHMARK_BENCH_H_ */
@@ -0,0 +1,50 @@
+// dedup.cpp : parses snapshots with repeated subtrees with and without deduplication
+//
+#include <sstream>
+#include "bench.h"
+#include "../imtjson/json.h"
+#include "../imtjson/dedup.h"
+
+using namespace json;
+
+static std::string buildSnapshot(std::size_t count) {
+	std::ostringstream buff;
+	buff << "[";
+	for (std::size_t i = 0; i < count; i++) {
+		if (i) buff << ",";
+		buff << "{\"id\":" << i << ",\"address\":{\"street\":\"Main street " << i % 20 << "\",\"city\":\"Prague\",\"zip\":\"11000\"}"
+			 << ",\"permissions\":{\"read\":true,\"write\":" << (i % 3 == 0?"true":"false") << ",\"roles\":[\"user\",\"viewer\"]}}";
+	}
+	buff << "]";
+	return buff.str();
+}
+
+static std::size_t countNodes(const Value &v) {
+	std::size_t cnt = 1;
+	for (Value x: v) cnt += countNodes(x);
+	return cnt;
+}
+
+static bench::Register dedupBench("dedup", "parsing snapshots with repeated subtrees, plain vs. deduplicated", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 20000;
+	std::string text = buildSnapshot(count);
+	typedef Parser<StreamFromString> P;
+
+	double r = bench::measure(params.threads, iterations, [&](std::size_t){
+		bench::keep(P(StreamFromString(text)).parse());
+	});
+	out << "parse: " << static_cast<std::size_t>(r * count) << " records/s" << std::endl;
+	r = bench::measure(params.threads, iterations, [&](std::size_t){
+		bench::keep(P(StreamFromString(text), P::dedupValues).parse());
+	});
+	out << "parse with dedup: " << static_cast<std::size_t>(r * count) << " records/s" << std::endl;
+	Value snapshot = P(StreamFromString(text)).parse();
+	r = bench::measure(params.threads, iterations, [&](std::size_t){
+		bench::keep(snapshot.dedup());
+	});
+	out << "Value::dedup: " << static_cast<std::size_t>(r * count) << " records/s" << std::endl;
+	DedupTable table;
+	table.dedup(snapshot.getHandle());
+	out << "nodes: " << countNodes(snapshot) << ", distinct nodes: " << table.size() << std::endl;
+});
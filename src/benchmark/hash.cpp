@@ -0,0 +1,47 @@
+// hash.cpp : compares and deduplicates large trees with and without cached hashes
+//
+#include <sstream>
+#include <unordered_set>
+#include "bench.h"
+#include "../imtjson/json.h"
+
+using namespace json;
+
+static std::string buildConfig(std::size_t variant) {
+	std::ostringstream buff;
+	buff << "{\"services\":[";
+	for (std::size_t i = 0; i < 200; i++) {
+		if (i) buff << ",";
+		buff << "{\"name\":\"service" << i << "\",\"port\":" << 8000 + i
+			 << ",\"replicas\":" << (i == 199?variant:3) << ",\"env\":{\"LEVEL\":\"info\",\"REGION\":\"eu\"}}";
+	}
+	buff << "]}";
+	return buff.str();
+}
+
+static std::size_t countEqual(const std::vector<Value> &configs) {
+	std::size_t cnt = 0;
+	for (const Value &x: configs) cnt += x == configs[0];
+	return cnt;
+}
+
+static bench::Register hashBench("hash", "comparing and deduplicating configuration trees which differ in a deep leaf, with and without cached hashes", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 200;
+	std::vector<Value> configs;
+	for (std::size_t i = 0; i < count; i++) configs.push_back(Value::fromString(buildConfig(i)));
+
+	double r = bench::measure(params.threads, iterations, [&](std::size_t){
+		bench::keep(countEqual(configs));
+	});
+	out << "compare, no hash: " << static_cast<std::size_t>(r * count) << " compares/s" << std::endl;
+	r = bench::measure(params.threads, iterations, [&](std::size_t){
+		std::unordered_set<Value> set(configs.begin(), configs.end());
+		bench::keep(set.size());
+	});
+	out << "dedup: " << static_cast<std::size_t>(r * count) << " values/s" << std::endl;
+	r = bench::measure(params.threads, iterations, [&](std::size_t){
+		bench::keep(countEqual(configs));
+	});
+	out << "compare, cached hash: " << static_cast<std::size_t>(r * count) << " compares/s" << std::endl;
+});
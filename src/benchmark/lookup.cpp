@@ -0,0 +1,32 @@
+// lookup.cpp : member lookup in objects of various sizes
+//
+#include <random>
+#include "bench.h"
+#include "../imtjson/json.h"
+
+using namespace json;
+
+static bench::Register lookupBench("lookup", "member lookup by key in objects from 4 to 64k keys, borrowed and as Value", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:2000000;
+	for (std::size_t count = 4; count <= 65536; count *= 4) {
+		std::vector<std::string> keys;
+		Object o;
+		for (std::size_t i = 0; i < count; i++) {
+			keys.push_back("user:" + std::to_string(i * 7919 % 1000003));
+			o.set(keys.back(), i);
+		}
+		Value obj(o);
+		std::mt19937 rnd(count);
+		std::vector<std::size_t> order(4096);
+		for (auto &x: order) x = rnd() % count;
+		double r = bench::measure(params.threads, iterations, [&](std::size_t idx){
+			bench::keep(ValueView(obj)[keys[order[idx & 4095]]].getUInt());
+		});
+		out << count << " keys: " << static_cast<std::size_t>(1e9 / r * params.threads) << " ns/lookup" << std::endl;
+		//returns the member with the key
+		r = bench::measure(params.threads, iterations, [&](std::size_t idx){
+			bench::keep(obj[keys[order[idx & 4095]]].getUInt());
+		});
+		out << count << " keys (Value): " << static_cast<std::size_t>(1e9 / r * params.threads) << " ns/lookup" << std::endl;
+	}
+});
@@ -0,0 +1,38 @@
+// main.cpp : runs benchmarks of the imtjson library
+//
+// usage: imtjson_bench [-t threads] [-n iterations] [name ...]
+//
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "bench.h"
+
+int main(int argc, char **argv) {
+	bench::Params params;
+	params.threads = 1;
+	params.iterations = 0;
+	std::vector<std::string> names;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i],"-t") == 0 && i+1 < argc) {
+			params.threads = std::strtoul(argv[++i],nullptr,10);
+		} else if (strcmp(argv[i],"-n") == 0 && i+1 < argc) {
+			params.iterations = std::strtoul(argv[++i],nullptr,10);
+		} else if (strcmp(argv[i],"-h") == 0) {
+			std::cout << "usage: imtjson_bench [-t threads] [-n iterations] [name ...]" << std::endl << std::endl;
+			for (const auto &b: bench::registry()) {
+				std::cout << "  " << b.name << " - " << b.description << std::endl;
+			}
+			return 0;
+		} else {
+			names.push_back(argv[i]);
+		}
+	}
+	if (params.threads == 0) params.threads = 1;
+	for (const auto &b: bench::registry()) {
+		if (names.empty() || std::find(names.begin(), names.end(), b.name) != names.end()) {
+			std::cout << "=== " << b.name << " (" << params.threads << " threads)" << std::endl;
+			b.fn(std::cout, params);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,48 @@
+// objects.cpp : parses and reads arrays of records with and without shapes
+//
+#include <sstream>
+#include "bench.h"
+#include "../imtjson/json.h"
+
+using namespace json;
+
+static std::string buildRecords(std::size_t count) {
+	std::ostringstream buff;
+	buff << "[";
+	for (std::size_t i = 0; i < count; i++) {
+		if (i) buff << ",";
+		buff << "{\"id\":" << i << ",\"name\":\"user" << i << "\",\"email\":\"user" << i << "@example.com\""
+			 << ",\"active\":" << (i & 1?"true":"false") << ",\"score\":" << i * 0.25
+			 << ",\"created\":\"2020-01-01\",\"updated\":\"2021-01-01\",\"group\":" << i % 7
+			 << ",\"role\":\"member\",\"country\":\"CZ\",\"lang\":\"cs\",\"flags\":" << i % 3 << "}";
+	}
+	buff << "]";
+	return buff.str();
+}
+
+static double readRecords(const Value &records) {
+	double sum = 0;
+	for (ValueView x: ValueView(records)) sum += x["score"].getNumber() + x["group"].getNumber();
+	return sum;
+}
+
+static bench::Register objectsBench("objects", "parsing and reading records, objects with shapes vs. plain objects", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 10000;
+	std::string text = buildRecords(count);
+
+	for (bool shapes: {false, true}) {
+		enableParseShapes = shapes;
+		const char *name = shapes?"shapes":"plain";
+		double r = bench::measure(params.threads, iterations, [&](std::size_t){
+			bench::keep(Value::fromString(text));
+		});
+		out << name << " parse: " << static_cast<std::size_t>(r * count) << " records/s" << std::endl;
+		Value records = Value::fromString(text);
+		r = bench::measure(params.threads, iterations * 10, [&](std::size_t){
+			bench::keep(readRecords(records));
+		});
+		out << name << " read: " << static_cast<std::size_t>(r * count) << " records/s" << std::endl;
+	}
+	enableParseShapes = true;
+});
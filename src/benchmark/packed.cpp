@@ -0,0 +1,100 @@
+// packed.cpp : parses, reads and serializes numeric arrays with and without packing
+//
+#include <sstream>
+#include "bench.h"
+#include "../imtjson/json.h"
+
+using namespace json;
+
+static std::string buildSeries(std::size_t count) {
+	std::ostringstream buff;
+	buff << "[";
+	for (std::size_t i = 0; i < count; i++) {
+		if (i) buff << ",";
+		buff << (i % 100) * 0.125 + 20.0625;
+	}
+	buff << "]";
+	return buff.str();
+}
+
+static double sumSeries(const Value &series) {
+	auto packed = series.getPacked<double>();
+	double sum = 0;
+	if (packed.first) {
+		for (double x: packed) sum += x;
+	} else {
+		for (ValueView x: ValueView(series)) sum += x.getNumber();
+	}
+	return sum;
+}
+
+static bench::Register packedBench("packed", "parsing, reading and serializing series of numbers, packed vs. plain arrays", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 100000;
+	std::string text = buildSeries(count);
+
+	for (bool packed: {false, true}) {
+		enableParsePackedArrays = packed;
+		const char *name = packed?"packed":"plain";
+		double r = bench::measure(params.threads, iterations, [&](std::size_t){
+			bench::keep(Value::fromString(text));
+		});
+		out << name << " parse: " << static_cast<std::size_t>(r * count) << " numbers/s" << std::endl;
+		Value series = Value::fromString(text);
+		r = bench::measure(params.threads, iterations * 10, [&](std::size_t){
+			bench::keep(sumSeries(series));
+		});
+		out << name << " read: " << static_cast<std::size_t>(r * count) << " numbers/s" << std::endl;
+		r = bench::measure(params.threads, iterations, [&](std::size_t){
+			bench::keep(series.stringify());
+		});
+		out << name << " serialize: " << static_cast<std::size_t>(r * count) << " numbers/s" << std::endl;
+	}
+	enableParsePackedArrays = false;
+});
+
+static std::string buildTags(std::size_t count) {
+	std::ostringstream buff;
+	buff << "[";
+	for (std::size_t i = 0; i < count; i++) {
+		if (i) buff << ",";
+		buff << "\"tag-" << (i * 7919) % 5000 << "\"";
+	}
+	buff << "]";
+	return buff.str();
+}
+
+static std::size_t scanTags(const Value &tags) {
+	std::size_t found = 0;
+	if (tags.flags() & packedStrings) {
+		for (StringView x: tags.getPackedStrings()) found += x == "tag-42";
+	} else {
+		for (ValueView x: ValueView(tags)) found += x.getString() == "tag-42";
+	}
+	return found;
+}
+
+static bench::Register packedStringsBench("packedStrings", "parsing, scanning and serializing lists of tags, packed vs. plain arrays", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 100000;
+	std::string text = buildTags(count);
+
+	for (bool packed: {false, true}) {
+		enableParsePackedArrays = packed;
+		const char *name = packed?"packed":"plain";
+		double r = bench::measure(params.threads, iterations, [&](std::size_t){
+			bench::keep(Value::fromString(text));
+		});
+		out << name << " parse: " << static_cast<std::size_t>(r * count) << " strings/s" << std::endl;
+		Value tags = Value::fromString(text);
+		r = bench::measure(params.threads, iterations * 10, [&](std::size_t){
+			bench::keep(scanTags(tags));
+		});
+		out << name << " scan: " << static_cast<std::size_t>(r * count) << " strings/s" << std::endl;
+		r = bench::measure(params.threads, iterations, [&](std::size_t){
+			bench::keep(tags.stringify());
+		});
+		out << name << " serialize: " << static_cast<std::size_t>(r * count) << " strings/s" << std::endl;
+	}
+	enableParsePackedArrays = false;
+});
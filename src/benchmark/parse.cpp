@@ -0,0 +1,104 @@
+// parse.cpp : parses a document through a character callback, from a contiguous buffer and with the structural index
+//
+#include <sstream>
+#include "bench.h"
+#include "../imtjson/json.h"
+#include "../imtjson/indexedParser.h"
+
+using namespace json;
+
+static std::string buildDocument(std::size_t count) {
+	std::ostringstream buff;
+	buff << "[\n";
+	for (std::size_t i = 0; i < count; i++) {
+		if (i) buff << ",\n";
+		buff << "  {\"id\": " << i << ", \"name\": \"user name " << i << "\", \"email\": \"user" << i << "@example.com\","
+			 << " \"score\": " << i * 0.25 << ", \"active\": " << (i % 2?"true":"false")
+			 << ", \"note\": \"line\\nbreak \\u00e9\", \"tags\": [\"alpha\", \"beta\", \"gamma\"]}";
+	}
+	buff << "\n]";
+	return buff.str();
+}
+
+static std::string buildTextDocument(std::size_t count) {
+	std::ostringstream buff;
+	buff << "[\n";
+	for (std::size_t i = 0; i < count; i++) {
+		if (i) buff << ",\n";
+		buff << "    {\n        \"title\": \"Article number " << i << "\",\n        \"body\": \"";
+		for (std::size_t j = 0; j < 40; j++) buff << "Lorem ipsum dolor sit amet, consectetur adipiscing elit. ";
+		buff << "\"\n    }";
+	}
+	buff << "\n]";
+	return buff.str();
+}
+
+static std::string buildQuotes(std::size_t count) {
+	std::ostringstream buff;
+	buff.precision(17);
+	buff << "[";
+	for (std::size_t i = 0; i < count; i++) {
+		if (i) buff << ",";
+		buff << "{\"bid\":" << 1.0 + i * 0.00013 << ",\"ask\":" << 1.00002 + i * 0.00013
+			 << ",\"size\":" << i % 1000 * 1000 << ",\"ts\":" << 1700000000000 + i << "}";
+	}
+	buff << "]";
+	return buff.str();
+}
+
+static std::string buildPrices(std::size_t count) {
+	std::ostringstream buff;
+	buff.precision(17);
+	buff << "[";
+	for (std::size_t i = 0; i < count; i++) {
+		if (i) buff << ",";
+		buff << 100.0 + (i % 9973) * 0.0123;
+	}
+	buff << "]";
+	return buff.str();
+}
+
+static void measureDocument(std::ostream &out, const bench::Params &params, std::size_t iterations, const std::string &text) {
+	double mb = text.size() / 1048576.0;
+	double r = bench::measure(params.threads, iterations, [&](std::size_t){
+		std::size_t pos = 0;
+		bench::keep(Value::parse([&]() -> int {
+			return pos < text.size()?static_cast<unsigned char>(text[pos++]):-1;
+		}));
+	});
+	out << "callback: " << static_cast<std::size_t>(r * mb) << " MB/s" << std::endl;
+	r = bench::measure(params.threads, iterations, [&](std::size_t){
+		bench::keep(Value::fromString(text));
+	});
+	out << "buffer: " << static_cast<std::size_t>(r * mb) << " MB/s" << std::endl;
+	r = bench::measure(params.threads, iterations, [&](std::size_t){
+		bench::keep(IndexedParser(text).parse());
+	});
+	out << "indexed: " << static_cast<std::size_t>(r * mb) << " MB/s" << std::endl;
+	for (auto impl: {StructuralIndex::scalar, StructuralIndex::sse2, StructuralIndex::avx2}) {
+		r = bench::measure(params.threads, iterations, [&](std::size_t){
+			StructuralIndex index;
+			index.build(text, impl);
+			bench::keep(index.size());
+		});
+		static const char *names[] = {"best", "scalar", "sse2", "avx2"};
+		out << "index only (" << names[impl] << "): " << static_cast<std::size_t>(r * mb) << " MB/s" << std::endl;
+	}
+}
+
+static bench::Register parseBench("parse", "parsing a document through a character callback vs. a contiguous buffer vs. the structural index", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 20000;
+	out << "records" << std::endl;
+	measureDocument(out, params, iterations, buildDocument(count));
+	out << "long strings" << std::endl;
+	measureDocument(out, params, iterations, buildTextDocument(count));
+	out << "numbers" << std::endl;
+	measureDocument(out, params, iterations, buildQuotes(count * 5));
+	std::string prices = buildPrices(count * 5);
+	double r = bench::measure(params.threads, iterations, [&](std::size_t){
+		typedef Parser<StreamFromString> P;
+		bench::keep(P(StreamFromString(prices), P::packArrays).parse());
+	});
+	out << "packed prices: " << static_cast<std::size_t>(r * count * 5) << " numbers/s" << std::endl;
+});
@@ -0,0 +1,61 @@
+// refcount.cpp : iterates large arrays with atomic, thread local and no (frozen) reference counting
+//
+#include "bench.h"
+#include "../imtjson/json.h"
+
+using namespace json;
+
+static Value buildArray(std::size_t count) {
+	Array arr;
+	arr.reserve(count);
+	for (std::size_t i = 0; i < count; i++) arr.push_back(i * 1.5);
+	return arr;
+}
+
+static double sumArray(const Value &arr) {
+	double sum = 0;
+	for (Value x: arr) sum += x.getNumber();
+	return sum;
+}
+
+static double sumArrayView(const Value &arr) {
+	double sum = 0;
+	for (ValueView x: ValueView(arr)) sum += x.getNumber();
+	return sum;
+}
+
+static bench::Register refcountBench("refcount", "iterating large arrays, atomic vs. thread local refcount vs. borrowed view vs. frozen", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:200;
+	const std::size_t count = 100000;
+
+	double r = bench::measure(params.threads, iterations, [&](std::size_t idx){
+		thread_local Value arr = buildArray(count);
+		bench::keep(sumArray(arr));
+	});
+	out << "atomic: " << static_cast<std::size_t>(r * count) << " items/s" << std::endl;
+
+	r = bench::measure(params.threads, iterations, [&](std::size_t idx){
+		LocalTreeScope scope;
+		thread_local Value arr = buildArray(count);
+		bench::keep(sumArray(arr));
+	});
+	out << "local: " << static_cast<std::size_t>(r * count) << " items/s" << std::endl;
+
+	r = bench::measure(params.threads, iterations, [&](std::size_t idx){
+		thread_local Value arr = buildArray(count);
+		bench::keep(sumArrayView(arr));
+	});
+	out << "view: " << static_cast<std::size_t>(r * count) << " items/s" << std::endl;
+
+	Value shared = buildArray(count);
+	r = bench::measure(params.threads, iterations, [&](std::size_t idx){
+		bench::keep(sumArray(shared));
+	});
+	out << "shared: " << static_cast<std::size_t>(r * count) << " items/s" << std::endl;
+
+	Value frozen = buildArray(count).freeze();
+	r = bench::measure(params.threads, iterations, [&](std::size_t idx){
+		bench::keep(sumArray(frozen));
+	});
+	out << "shared, frozen: " << static_cast<std::size_t>(r * count) << " items/s" << std::endl;
+});
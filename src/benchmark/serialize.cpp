@@ -0,0 +1,108 @@
+// serialize.cpp : serializes documents with plain strings and with strings which need escaping,
+//                 notifications embedding a shared subtree with and without the serialized cache,
+//                 doubles in the rounded and in the shortest round-trip format, and integers (IDs and timestamps)
+//
+#include <random>
+#include <sstream>
+#include "bench.h"
+#include "../imtjson/json.h"
+
+using namespace json;
+
+static Value buildDocument(std::size_t count, bool escaped) {
+	Array res;
+	for (std::size_t i = 0; i < count; i++) {
+		std::string text = "Lorem ipsum dolor sit amet, consectetur adipiscing elit " + std::to_string(i);
+		if (escaped) text.append("\n");
+		res.push_back(Value(object, {
+				Value("id", i),
+				Value("name", "record-" + std::to_string(i)),
+				Value("description", text),
+				Value("tags", {"alpha","beta","gamma"})
+		}));
+	}
+	return res;
+}
+
+static bench::Register serializeBench("serialize", "serializing records with plain strings vs. strings which need escaping", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 20000;
+
+	for (bool escaped: {false, true}) {
+		const char *name = escaped?"escaped":"plain";
+		Value doc = buildDocument(count, escaped);
+		double mb = doc.stringify().length() / 1048576.0;
+		double r = bench::measure(params.threads, iterations, [&](std::size_t){
+			bench::keep(doc.stringify());
+		});
+		out << name << " stringify: " << static_cast<std::size_t>(r * mb) << " MB/s" << std::endl;
+		r = bench::measure(params.threads, iterations, [&](std::size_t){
+			std::ostringstream buff;
+			doc.toStream(buff);
+			bench::keep(buff.tellp());
+		});
+		out << name << " toStream: " << static_cast<std::size_t>(r * mb) << " MB/s" << std::endl;
+	}
+});
+
+static bench::Register fanoutBench("fanout", "serializing notifications with a shared profile, plain vs. cached subtree", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t subscribers = 10000;
+	Value profile = buildDocument(50, false);
+
+	for (bool cached: {false, true}) {
+		const char *name = cached?"cached":"plain";
+		Value shared = cached?profile.cacheSerialized():profile;
+		double r = bench::measure(params.threads, iterations, [&](std::size_t){
+			for (std::size_t i = 0; i < subscribers; i++) {
+				Value msg(object, {Value("subscriber", i), Value("profile", shared)});
+				bench::keep(msg.stringify());
+			}
+		});
+		out << name << ": " << static_cast<std::size_t>(r * subscribers) << " messages/s" << std::endl;
+	}
+});
+
+static bench::Register doublesBench("doubles", "serializing doubles rounded to 9 digits vs. the shortest round-trip format", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 100000;
+	std::mt19937_64 rnd(1);
+	std::uniform_real_distribution<double> prices(0.0, 10000.0);
+	std::uniform_real_distribution<double> exponents(-300.0, 300.0);
+	Array items;
+	for (std::size_t i = 0; i < count; i++) {
+		items.push_back(i & 1?prices(rnd):std::pow(10.0, exponents(rnd)));
+	}
+	Value doc = items;
+	uintptr_t saved = maxPrecisionDigits;
+
+	for (uintptr_t precision: {uintptr_t(9), shortestPrecision}) {
+		const char *name = precision == shortestPrecision?"shortest":"rounded";
+		maxPrecisionDigits = precision;
+		double r = bench::measure(params.threads, iterations, [&](std::size_t){
+			bench::keep(doc.stringify());
+		});
+		out << name << ": " << static_cast<std::size_t>(r * count) << " numbers/s" << std::endl;
+	}
+	maxPrecisionDigits = saved;
+});
+
+static bench::Register integersBench("integers", "serializing arrays of integers (IDs and timestamps)", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 100000;
+	Array ids, timestamps;
+	for (std::size_t i = 0; i < count; i++) {
+		ids.push_back(i * 7919 % 1000003);
+		timestamps.push_back(static_cast<LongInt>(1700000000000LL + i * 1013));
+	}
+	Value docs[] = {ids, timestamps};
+	const char *names[] = {"ids", "timestamps"};
+
+	for (int i = 0; i < 2; i++) {
+		Value doc = docs[i];
+		double r = bench::measure(params.threads, iterations, [&](std::size_t){
+			bench::keep(doc.stringify());
+		});
+		out << names[i] << ": " << static_cast<std::size_t>(r * count) << " numbers/s" << std::endl;
+	}
+});
@@ -0,0 +1,37 @@
+// zerocopy.cpp : parses documents with long strings with and without copying the strings
+//
+#include <sstream>
+#include "bench.h"
+#include "../imtjson/json.h"
+#include "../imtjson/sharedBuffer.h"
+
+using namespace json;
+
+static std::string buildDocument(std::size_t count) {
+	std::ostringstream buff;
+	buff << "[";
+	for (std::size_t i = 0; i < count; i++) {
+		if (i) buff << ",";
+		buff << "{\"id\":" << i << ",\"payload\":\"";
+		for (std::size_t j = 0; j < 1000; j++) buff << static_cast<char>('a' + (i + j) % 26);
+		buff << "\"}";
+	}
+	buff << "]";
+	return buff.str();
+}
+
+static bench::Register zerocopyBench("zerocopy", "parsing documents with long strings, copied vs. referred strings", [](std::ostream &out, const bench::Params &params) {
+	std::size_t iterations = params.iterations?params.iterations:20;
+	const std::size_t count = 4000;
+	PSharedBuffer text = SharedBuffer::create(buildDocument(count));
+	double mb = text->getData().size() / 1048576.0;
+
+	double r = bench::measure(params.threads, iterations, [&](std::size_t){
+		bench::keep(Value::fromString(text->getData()));
+	});
+	out << "copy: " << static_cast<std::size_t>(r * mb) << " MB/s" << std::endl;
+	r = bench::measure(params.threads, iterations, [&](std::size_t){
+		bench::keep(Value::fromBuffer(text));
+	});
+	out << "refer: " << static_cast<std::size_t>(r * mb) << " MB/s" << std::endl;
+});
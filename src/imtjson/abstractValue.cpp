@@ -1,3 +1,5 @@
+#include <cstdint>
+#include <cstring>
 #include "abstractValue.h"
 
 namespace json {
@@ -10,7 +12,7 @@ namespace json {
 	class UndefinedValue : public AbstractValue {
 	public:
 		UndefinedValue() {
-			addRef();
+			setImmortal();
 		}
 	};
 
@@ -20,6 +22,69 @@ namespace json {
 		return &undefinedVal;
 	}
 
+	std::size_t IValue::hash() const {
+		return AbstractValue::hashValue(this);
+	}
+
+	static const std::size_t hashBasis = sizeof(std::size_t) > 4?static_cast<std::size_t>(14695981039346656037ULL):2166136261;
+
+	std::size_t AbstractValue::hashString(const std::string_view &str) {
+		std::size_t h = hashSeed(string);
+		for (char c: str) h = hashCombine(h, static_cast<unsigned char>(c));
+		return hashFinish(h);
+	}
+
+	std::size_t AbstractValue::hashNumber(double val) {
+		//integers and floats are equal, if their values are equal. Also 0.0 == -0.0
+		if (val == 0) val = 0;
+		std::uint64_t bits;
+		std::memcpy(&bits, &val, sizeof(bits));
+		std::size_t h = hashSeed(number);
+		for (int i = 0; i < 64; i+=8) h = hashCombine(h, static_cast<std::uint8_t>(bits >> i));
+		return hashFinish(h);
+	}
+
+	std::size_t AbstractValue::hashSeed(ValueType type) {
+		return hashCombine(hashBasis, static_cast<std::size_t>(type));
+	}
+
+	std::size_t AbstractValue::hashValue(const IValue *v) {
+		ValueType t = v->type();
+		switch (t) {
+			default: return hashFinish(hashSeed(t));
+			case boolean: return hashFinish(hashCombine(hashSeed(t), v->getBool()?1:0));
+			case number: return hashNumber(v->getNumber());
+			case string: return hashString(v->getString());
+			case array: {
+				std::size_t h = hashSeed(t);
+				std::size_t cnt = v->size();
+				for (std::size_t i = 0; i < cnt; i++) h = hashCombine(h, ItemRef(v, i)->hash());
+				return hashFinish(h);
+			}
+			case object: {
+				std::size_t h = hashSeed(t);
+				std::size_t cnt = v->size();
+				for (std::size_t i = 0; i < cnt; i++) {
+					ItemRef item(v, i);
+					h = hashCombine(h, hashString(item.getMemberName()));
+					h = hashCombine(h, item->hash());
+				}
+				return hashFinish(h);
+			}
+		}
+	}
+
+	bool AbstractValue::forEachRef(const IEnumFn &fn) const {
+		ValueType t = type();
+		if (t == array || t == object) {
+			std::size_t cnt = size();
+			for (std::size_t i = 0; i < cnt; i++) {
+				if (!fn(itemAtIndex(i))) return false;
+			}
+		}
+		return true;
+	}
+
 	int AbstractValue::compare(const IValue *other) const {
 		ValueType lt = type();
 		ValueType rt = other->type();
@@ -56,7 +121,7 @@ namespace json {
 					std::size_t s2 = other->size();
 					std::size_t sz = std::min(s1,s2);
 					for (std::size_t i = 0; i < sz; i++) {
-						int z = this->itemAtIndex(i)->compare(other->itemAtIndex(i));
+						int z = ItemRef(this, i)->compare(ItemRef(other, i));
 						if (z != 0) return z;
 					}
 					return s1<s2?-1:s1>s2?1:0;
@@ -66,9 +131,9 @@ namespace json {
 					std::size_t s2 = other->size();
 					std::size_t sz = std::min(s1,s2);
 					for (std::size_t i = 0; i < sz; i++) {
-						const IValue *l = itemAtIndex(i);
-						const IValue *r = other->itemAtIndex(i);
-						int zk = sign(l->getMemberName().compare(r->getMemberName()));
+						ItemRef l(this, i);
+						ItemRef r(other, i);
+						int zk = sign(l.getMemberName().compare(r.getMemberName()));
 						if (zk != 0) return zk;
 						int zv = l->compare(r);
 						if (zv != 0) return zv;
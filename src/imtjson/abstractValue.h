@@ -1,9 +1,36 @@
 #pragma once
 
+#include <atomic>
 #include "ivalue.h"
 
 namespace json {
 
+	///Keeps the structural hash of an immutable value
+	/** The hash is calculated on the first request. Zero means, that the hash
+	 * has not been calculated yet (calculated hashes are never zero). Copy of the value
+	 * starts with no hash
+	 */
+	class HashCache {
+	public:
+		HashCache() {}
+		HashCache(const HashCache &) {}
+		HashCache &operator=(const HashCache &) {val.store(0, std::memory_order_relaxed); return *this;}
+
+		template<typename Fn>
+		std::size_t get(Fn &&calc) const {
+			std::size_t h = val.load(std::memory_order_relaxed);
+			if (h == 0) {
+				h = calc();
+				val.store(h, std::memory_order_relaxed);
+			}
+			return h;
+		}
+		std::size_t peek() const {return val.load(std::memory_order_relaxed);}
+
+	protected:
+		mutable std::atomic<std::size_t> val = 0;
+	};
+
 
 
 	class AbstractValue : public IValue {
@@ -37,7 +64,37 @@ namespace json {
 		 */
 		virtual int compare(const IValue *other) const override;
 
+		///Default implementation enumerates items of arrays and objects
+		virtual bool forEachRef(const IEnumFn &fn) const override;
+
 		static const IValue * getUndefined();
+
+		///Calculates structural hash of any value without caching
+		/** Hashes of the items are retrieved by IValue::hash(), so cached hashes of nested
+		 * containers are used */
+		static std::size_t hashValue(const IValue *v);
+		///Hash of a string
+		static std::size_t hashString(const std::string_view &str);
+		///Hash of a number
+		static std::size_t hashNumber(double val);
+		///Initial hash of a container
+		static std::size_t hashSeed(ValueType type);
+		///Adds hash of an item to the hash of a container
+		static std::size_t hashCombine(std::size_t h, std::size_t item) {
+			return (h ^ item) * hashPrime;
+		}
+		///Finishes hash of a container (the hash is never zero)
+		static std::size_t hashFinish(std::size_t h) {return h?h:1;}
+		///Returns true, if both values have the hash calculated and the hashes are different
+		static bool hashDiffers(const IValue *a, const IValue *b) {
+			std::size_t ha = a->cachedHash();
+			if (ha == 0) return false;
+			std::size_t hb = b->cachedHash();
+			return hb != 0 && ha != hb;
+		}
+
+	protected:
+		static const std::size_t hashPrime = sizeof(std::size_t) > 4?static_cast<std::size_t>(1099511628211ULL):16777619;
 	};
 
 }
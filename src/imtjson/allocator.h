@@ -23,6 +23,11 @@ namespace json {
 
 
 		static const Allocator *getInstance();
+		///Returns allocator which uses standard heap (operator new and delete)
+		static const Allocator *getHeap();
+		///Returns thread-caching pool allocator (default)
+		/** @see PoolAllocator */
+		static const Allocator *getPool();
 
 	};
 
@@ -0,0 +1,88 @@
+#include "arena.h"
+#include "chunkMap.h"
+#include "value.h"
+
+namespace json {
+
+	struct ArenaChunk: public ChunkHeader {
+		Arena *owner;
+		ArenaChunk *next;
+	};
+
+	static const std::size_t arenaAlign = alignof(std::max_align_t);
+	static const std::size_t arenaHeaderSize = (sizeof(ArenaChunk) + arenaAlign - 1) & ~(arenaAlign - 1);
+	///Larger blocks are allocated by the standard allocator
+	static const std::size_t arenaMaxBlock = ChunkMap::chunkSize / 8;
+
+	thread_local Arena *Arena::curArena = nullptr;
+
+	Arena::Arena():pos(nullptr),end(nullptr),chunks(nullptr),reserved(0) {}
+
+	PArena Arena::create() {
+		return new Arena;
+	}
+
+	Arena::~Arena() {
+		while (chunks) {
+			ArenaChunk *c = chunks;
+			chunks = c->next;
+			ChunkMap::freeChunk(c);
+		}
+	}
+
+	void Arena::allocChunk() {
+		void *m = ChunkMap::allocChunk(ChunkMap::chunkSize);
+		if (m == nullptr) {
+			pos = end = nullptr;
+			return;
+		}
+		ArenaChunk *c = reinterpret_cast<ArenaChunk *>(m);
+		c->release = &releaseBlock;
+		c->owner = this;
+		c->next = chunks;
+		chunks = c;
+		pos = reinterpret_cast<char *>(m) + arenaHeaderSize;
+		end = reinterpret_cast<char *>(m) + ChunkMap::chunkSize;
+	}
+
+	void *Arena::alloc(std::size_t sz) {
+		sz = (sz + arenaAlign - 1) & ~(arenaAlign - 1);
+		if (sz <= arenaMaxBlock) {
+			if (static_cast<std::size_t>(end - pos) < sz) allocChunk();
+			if (pos != nullptr) {
+				void *r = pos;
+				pos += sz;
+				if (reserved == 0) {
+					counter.fetch_add(refBatch, std::memory_order_relaxed);
+					reserved = refBatch;
+				}
+				--reserved;
+				return r;
+			}
+		}
+		return Value::allocator->alloc(sz);
+	}
+
+	void Arena::releaseBlock(ChunkHeader *chunk, void *) {
+		Arena *a = static_cast<ArenaChunk *>(chunk)->owner;
+		if (a->release()) delete a;
+	}
+
+	void Arena::releaseReserved() {
+		//the caller holds a reference, so the counter can't reach zero
+		if (reserved) counter.fetch_sub(reserved, std::memory_order_relaxed);
+		reserved = 0;
+	}
+
+	ArenaScope::ArenaScope(const PArena &arena):arena(arena),prev(Arena::curArena) {
+		if (arena != nullptr) Arena::curArena = arena;
+	}
+
+	ArenaScope::~ArenaScope() {
+		if (arena != nullptr) {
+			arena->releaseReserved();
+			Arena::curArena = prev;
+		}
+	}
+
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include "refcnt.h"
+
+namespace json {
+
+	struct ArenaChunk;
+	class Arena;
+
+	typedef RefCntPtr<Arena> PArena;
+
+	///Monotonic allocator for whole trees of values
+	/** The arena allocates values in large chunks. Individual values are never
+	 * released, the memory of the arena is released all at once when the last
+	 * value allocated in the arena is destroyed.
+	 *
+	 * The arena is used through ArenaScope. While the scope is active, all
+	 * values created by the current thread are allocated in the arena. The parsers
+	 * (Parser, BinaryParser) can be told to use the arena directly.
+	 *
+	 * @code
+	 * Value v;
+	 * {
+	 *    ArenaScope scope(Arena::create());
+	 *    v = Value::fromString(text);
+	 * }
+	 * //the arena is released once the 'v' is released
+	 * @endcode
+	 *
+	 * @note The arena can be used by one thread at time to allocate values. Values allocated in the arena
+	 * can be shared and released by any thread
+	 *
+	 * @note Only small blocks are allocated in the arena. Large blocks (large containers
+	 * and long strings) are allocated by the standard allocator.
+	 */
+	class Arena: public RefCntObj {
+	public:
+
+		///Creates new arena
+		static PArena create();
+
+		~Arena();
+
+		///Allocates block in the arena
+		/** Every block holds a reference to the arena, which is released, when the block is deallocated.
+		 * The references are taken from a batch reserved by the allocating thread, so the counter is
+		 * updated once per batch, not once per block. Unused references are returned when the
+		 * ArenaScope ends.
+		 * @param sz size of the block
+		 * @return pointer to the block
+		 */
+		void *alloc(std::size_t sz);
+
+		///Returns arena currently active for this thread
+		/** @return pointer to arena, or nullptr, if there is no active arena */
+		static Arena *current() {return curArena;}
+
+	protected:
+		Arena();
+		Arena(const Arena &) = delete;
+		Arena &operator=(const Arena &) = delete;
+
+		char *pos;
+		char *end;
+		ArenaChunk *chunks;
+		///References already added to the counter for the next blocks
+		long reserved;
+
+		///Count of references reserved at once
+		static const long refBatch = 1024;
+
+		void allocChunk();
+		///Returns unused reserved references
+		void releaseReserved();
+
+		static void releaseBlock(struct ChunkHeader *chunk, void *ptr);
+
+		static thread_local Arena *curArena;
+
+		friend class ArenaScope;
+		friend class ArenaSuspend;
+	};
+
+	///Activates the arena for the current thread
+	/** Scopes can be nested. Destruction of the scope restores the previous arena.
+	 * If the scope is constructed with nullptr, it does nothing.
+	 */
+	class ArenaScope {
+	public:
+		explicit ArenaScope(const PArena &arena);
+		~ArenaScope();
+
+		ArenaScope(const ArenaScope &) = delete;
+		ArenaScope &operator=(const ArenaScope &) = delete;
+
+		///Retrieves arena of this scope
+		const PArena &getArena() const {return arena;}
+
+	protected:
+		PArena arena;
+		Arena *prev;
+	};
+
+	///Suspends the arena of the current thread
+	/** While the object exists, values are allocated by the standard allocator even if an
+	 * arena is active. It is intended for values which can outlive the arena (shared caches)
+	 */
+	class ArenaSuspend {
+	public:
+		ArenaSuspend():prev(Arena::curArena) {Arena::curArena = nullptr;}
+		~ArenaSuspend() {Arena::curArena = prev;}
+
+		ArenaSuspend(const ArenaSuspend &) = delete;
+		ArenaSuspend &operator=(const ArenaSuspend &) = delete;
+
+	protected:
+		Arena *prev;
+	};
+
+}
@@ -19,6 +19,12 @@ namespace json {
 		return getUndefined();
 	}
 
+	const IValue *ArrayValue::borrowAtIndex(std::size_t index) const
+	{
+		if (index < curSize) return (*this)[index];
+		return getUndefined();
+	}
+
 
 	RefCntPtr<ArrayValue> ArrayValue::create(std::size_t capacity) {
 		AllocInfo req(capacity);
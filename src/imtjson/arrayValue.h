@@ -17,8 +17,10 @@ namespace json {
 		
 		virtual std::size_t size() const override;
 		virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const override;
+		virtual const IValue *borrowAtIndex(std::size_t index) const override;
 
 		virtual bool getBool() const override {return true;}
+		virtual std::size_t memorySize() const override {return sizeof(ArrayValue) + capacity * sizeof(PValue);}
 
 
 		static RefCntPtr<ArrayValue> create(std::size_t capacity);
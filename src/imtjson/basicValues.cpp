@@ -1,13 +1,41 @@
+#include <type_traits>
 #include "basicValues.h"
 
 #include "value.h"
 namespace json {
 
+///Static value constructed on first access
+/** The value is stored in the static storage (it is never allocated by the allocator
+ * nor in the arena). It is immortal, so copying of its reference doesn't need atomic
+ * operations. The value is never destroyed
+ */
 template<typename T>
-class AllocOnFirstAccess: public RefCntPtr<IValue> {
+class StaticValue {
 public:
-	AllocOnFirstAccess():RefCntPtr<IValue>(new T) {}
+	StaticValue() {
+		T *v = ::new(&storage) T;
+		v->setImmortal();
+	}
+	operator const IValue *() const {return reinterpret_cast<const T *>(&storage);}
+protected:
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+};
 
+///Static table of preallocated numbers
+template<typename NumT, typename T, T minVal, T maxVal>
+class StaticNumbers {
+public:
+	StaticNumbers() {
+		for (T i = minVal; i <= maxVal; i++) {
+			NumT *v = ::new(&items[i - minVal]) NumT(i);
+			v->setImmortal();
+		}
+	}
+	const IValue *operator[](T v) const {
+		return reinterpret_cast<const NumT *>(&items[v - minVal]);
+	}
+protected:
+	typename std::aligned_storage<sizeof(NumT), alignof(NumT)>::type items[maxVal - minVal + 1];
 };
 
 
@@ -49,7 +77,7 @@ public:
 
 
 	const IValue *NullValue::getNull() {
-		static AllocOnFirstAccess<NullValue> staticNull;
+		static StaticValue<NullValue> staticNull;
 		return staticNull;
 
 	}
@@ -60,8 +88,8 @@ public:
 
 	const IValue * BoolValue::getBool(bool v)
 	{
-		static AllocOnFirstAccess< StaticBool<false> >boolFalse;
-		static AllocOnFirstAccess< StaticBool<true> >boolTrue;
+		static StaticValue< StaticBool<false> >boolFalse;
+		static StaticValue< StaticBool<true> >boolTrue;
 
 		if (v) return boolTrue;
 		else return boolFalse;
@@ -70,21 +98,42 @@ public:
 
 	const IValue * AbstractNumberValue::getZero()
 	{
-		static AllocOnFirstAccess<StaticZeroNumber>zero;
+		static StaticValue<StaticZeroNumber>zero;
 		return zero;
 	}
 
 
+	const IValue * AbstractNumberValue::getSmallInt(Int v)
+	{
+		static StaticNumbers<IntegerValue, Int, smallIntMin, smallIntMax> numbers;
+		return numbers[v];
+	}
+
+	const IValue * AbstractNumberValue::getSmallUInt(UInt v)
+	{
+		static StaticNumbers<UnsignedIntegerValue, UInt, 0, smallIntMax> numbers;
+		return numbers[v];
+	}
+
+
+	ValueTypeFlags AbstractStringValue::checkPlain(const std::string_view &str) {
+		for (char c: str) {
+			unsigned char u = static_cast<unsigned char>(c);
+			if (u < 32 || u >= 128 || u == '"' || u == '\\') return 0;
+		}
+		return plainString;
+	}
+
 	const IValue * AbstractStringValue::getEmptyString()
 	{
-		static AllocOnFirstAccess<StaticEmptyStringValue> emptyStr;
+		static StaticValue<StaticEmptyStringValue> emptyStr;
 		return emptyStr;
 	}
 
 
 	const IValue * AbstractArrayValue::getEmptyArray()
 	{
-		static AllocOnFirstAccess<StaticEmptyArrayValue> emptyArray;
+		static StaticValue<StaticEmptyArrayValue> emptyArray;
 		return emptyArray;
 	}
 
@@ -92,7 +141,7 @@ public:
 
 	const IValue * AbstractObjectValue::getEmptyObject()
 	{
-		static AllocOnFirstAccess<StaticEmptyObjectValue> emptyObject;
+		static StaticValue<StaticEmptyObjectValue> emptyObject;
 		return emptyObject;
 	}
 
@@ -121,11 +170,12 @@ public:
 
 	bool AbstractArrayValue::equal(const IValue* other) const {
 		if (other->type() == array && other->size() == size()) {
+			if (hashDiffers(this, other)) return false;
 			std::size_t cnt = size();
 			for (std::size_t i = 0; i < cnt; i++) {
-				const IValue *a = itemAtIndex(i);
-				const IValue *b = other->itemAtIndex(i);
-				if (a != b && !a->equal(b)) return false;
+				ItemRef a(this, i);
+				ItemRef b(other, i);
+				if (a.get() != b.get() && !a->equal(b)) return false;
 			}
 			return true;
 		}
@@ -133,11 +183,13 @@ public:
 	}
 	bool AbstractObjectValue::equal(const IValue *other) const {
 		if (other->type() == object && other->size() == size()) {
+			if (hashDiffers(this, other)) return false;
 			std::size_t cnt = size();
 			for (std::size_t i = 0; i < cnt; i++) {
-				const IValue *a = itemAtIndex(i);
-				const IValue *b = other->itemAtIndex(i);
-				if (a != b && (a->getMemberName() != b->getMemberName() || !a->equal(b)))
+				ItemRef a(this, i);
+				ItemRef b(other, i);
+				if (a.getMemberName() != b.getMemberName()) return false;
+				if (a.get() != b.get() && !a->equal(b))
 					return false;
 			}
 			return true;
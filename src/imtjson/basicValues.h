@@ -45,6 +45,26 @@ namespace json {
 
 		static const IValue *getZero();
 
+		///Lowest integer number, which is preallocated
+		static const Int smallIntMin = -128;
+		///Highest integer number, which is preallocated
+		static const Int smallIntMax = 1023;
+
+		///Returns preallocated signed number
+		/**
+		 * @param v number, it must be in range smallIntMin and smallIntMax
+		 * @return static value. It is immortal, so it doesn't need allocation nor
+		 * atomic refcounting
+		 */
+		static const IValue *getSmallInt(Int v);
+		///Returns preallocated unsigned number
+		/**
+		 * @param v number, it must be in range 0 and smallIntMax
+		 * @return static value. It is immortal, so it doesn't need allocation nor
+		 * atomic refcounting
+		 */
+		static const IValue *getSmallUInt(UInt v);
+
 
 		virtual bool equal(const IValue *other) const override;
 
@@ -65,6 +85,11 @@ namespace json {
 		static const IValue *getEmptyString();
 		virtual bool equal(const IValue *other) const override;
 
+		///Determines, whether the string can be serialized without escaping
+		/** @return plainString if the string contains only printable ASCII characters
+		 * excluding quotes and backslash, otherwise returns 0 */
+		static ValueTypeFlags checkPlain(const std::string_view &str);
+
 	};
 
 	class AbstractArrayValue : public AbstractValue {
@@ -75,6 +100,14 @@ namespace json {
 
 		static const IValue *getEmptyArray();
 		virtual bool equal(const IValue *other) const override;
+		virtual std::size_t hash() const override {return hashCache.get([&]{return calcHash();});}
+		virtual std::size_t cachedHash() const override {return hashCache.peek();}
+
+	protected:
+		HashCache hashCache;
+
+		///Calculates the hash, it is called once
+		virtual std::size_t calcHash() const {return hashValue(this);}
 	};
 
 	class AbstractObjectValue : public AbstractValue {
@@ -84,8 +117,13 @@ namespace json {
 		virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const override = 0;
 		virtual RefCntPtr<const IValue> member(const std::string_view &name) const override = 0;
 		virtual bool equal(const IValue *other) const override;
+		virtual std::size_t hash() const override {return hashCache.get([&]{return hashValue(this);});}
+		virtual std::size_t cachedHash() const override {return hashCache.peek();}
 
 		static const IValue *getEmptyObject();
+
+	protected:
+		HashCache hashCache;
 	};
 	
 	template<typename T, ValueTypeFlags f >
@@ -99,6 +137,7 @@ namespace json {
 		virtual LongInt getIntLong() const override {return LongInt(v);}
 		virtual ULongInt getUIntLong() const override {return ULongInt(v);}
 		virtual ValueTypeFlags flags() const override { return f; }
+		virtual std::size_t memorySize() const override {return sizeof(*this);}
 		virtual bool equal(const IValue *other) const  override {
 			if (other->type() == number) {
 				const NumberValueT *k = dynamic_cast<const NumberValueT *>(other->unproxy());
@@ -12,6 +12,7 @@
 #include <unordered_map>
 #include <memory>
 #include "base64.h"
+#include "arena.h"
 
 namespace json {
 
@@ -24,6 +25,14 @@ template<typename Fn>
 class BinaryParser {
 public:
 	BinaryParser(const Fn &fn, BinaryEncoding binaryEncoding);
+	///Construct parser which allocates values in given arena
+	/**
+	 * @param fn source function
+	 * @param binaryEncoding binary encoding
+	 * @param arena arena used to allocate parsed values. The arena is active for the
+	 *  current thread until the parser is destroyed
+	 */
+	BinaryParser(const Fn &fn, BinaryEncoding binaryEncoding, const PArena &arena);
 
 	///Parse binary json
 	Value parse();
@@ -40,6 +49,7 @@ protected:
 	Value parseItem();
 
 	Value parseKey(unsigned char tag);
+	Value bindKey(const String &key, const Value &v);
 	Value parseArray(unsigned char tag, bool diff);
 	Value parseObject(unsigned char tag,bool diff);
 	Value parseString(unsigned char tag, BinaryEncoding encoding);
@@ -61,6 +71,7 @@ protected:
 	std::vector<String> keyHistory;
 	unsigned int keyIndex = 0;
 	std::string buffer;
+	ArenaScope arenaScope;
 
 private:
 	void storeKey(const String& s);
@@ -121,7 +132,16 @@ protected:
 	void writePOD(const T &val, unsigned char type);
 
 	void serialize(const IValue *v);
+	void serializeKey(const std::string_view &key);
+	void serializeItem(const IValue *v);
 	void serializeContainer(const IValue *v, unsigned char type);
+	///Serializes packed array without materializing the items
+	/** @retval false not a packed array of given type */
+	template<typename T>
+	bool serializePacked(const IValue *v);
+	///Serializes packed string array without materializing the items
+	/** @retval false not a packed string array */
+	bool serializePackedStrings(const IValue *v);
 	void serializeString(const std::string_view &str, unsigned char type);
 	void serializeNumber(const IValue *v);
 	void serializeInteger(std::size_t, unsigned char type);
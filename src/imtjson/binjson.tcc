@@ -11,6 +11,10 @@
 #include "stringValue.h"
 #include "binjson.h"
 #include "binary.h"
+#include "key.h"
+#include "keyTable.h"
+#include "packedArray.h"
+#include "parser.h"
 
 
 #pragma once
@@ -75,7 +79,12 @@ void BinarySerializer<Fn>::serialize(const Value &v) {
 
 template<typename Fn>
 void BinarySerializer<Fn>::serialize(const IValue *v) {
-	std::string_view key = v->getMemberName();
+	serializeKey(v->getMemberName());
+	serializeItem(v);
+}
+
+template<typename Fn>
+void BinarySerializer<Fn>::serializeKey(const std::string_view &key) {
 	if (!key.empty()) {
 		if (flags & compressKeys) {
 			int code = tryCompressKey(key);
@@ -86,6 +95,10 @@ void BinarySerializer<Fn>::serialize(const IValue *v) {
 			serializeString(key, opcode::key);
 		}
 	}
+}
+
+template<typename Fn>
+void BinarySerializer<Fn>::serializeItem(const IValue *v) {
 	switch(v->type()) {
 	case object: serializeContainer(v,opcode::object);break;
 	case array: serializeContainer(v,opcode::array);break;
@@ -106,9 +119,43 @@ template<typename Fn>
 void BinarySerializer<Fn>::serializeContainer(const IValue *v, unsigned char type) {
 	std::size_t cnt = v->size();
 	serializeInteger(cnt, type);
+	if (type == opcode::object) {
+		for (std::size_t i = 0; i < cnt; i++) {
+			ItemRef item(v, i);
+			serializeKey(item.getMemberName());
+			serializeItem(item);
+		}
+	} else if (!serializePacked<double>(v) && !serializePacked<LongInt>(v) && !serializePacked<ULongInt>(v)
+			&& !serializePackedStrings(v)) {
+		for (std::size_t i = 0; i < cnt; i++) {
+			serialize(ItemRef(v, i));
+		}
+	}
+}
+
+template<typename Fn>
+bool BinarySerializer<Fn>::serializePackedStrings(const IValue *v) {
+	const PackedStringArrayValue *arr = PackedStringArrayValue::cast(v);
+	if (arr == nullptr) return false;
+	for (StringView str: arr->getStrings()) {
+		serializeString(str, opcode::string);
+	}
+	return true;
+}
+
+template<typename Fn>
+template<typename T>
+bool BinarySerializer<Fn>::serializePacked(const IValue *v) {
+	const PackedArrayValue<T> *arr = PackedArrayValue<T>::cast(v);
+	if (arr == nullptr) return false;
+	const T *d = arr->data();
+	std::size_t cnt = arr->size();
 	for (std::size_t i = 0; i < cnt; i++) {
-		serialize((const IValue *)v->itemAtIndex(i));
+		//temporary number is not shared, it doesn't need allocation
+		NumberValueT<T, PackedArrayValue<T>::itemFlags> n(d[i]);
+		serializeNumber(&n);
 	}
+	return true;
 }
 
 static inline bool canCompressString(const std::string_view &str) {
@@ -228,7 +275,16 @@ void BinarySerializer<Fn>::serializeUndefined(const IValue *) {
 
 
 template<typename Fn>
-BinaryParser<Fn>::BinaryParser(const Fn &fn, BinaryEncoding binaryEncoding):fn(fn),curBinaryEncoding(binaryEncoding) {}
+BinaryParser<Fn>::BinaryParser(const Fn &fn, BinaryEncoding binaryEncoding):fn(fn),curBinaryEncoding(binaryEncoding),arenaScope(nullptr) {}
+
+template<typename Fn>
+BinaryParser<Fn>::BinaryParser(const Fn &fn, BinaryEncoding binaryEncoding, const PArena &arena):fn(fn),curBinaryEncoding(binaryEncoding),arenaScope(arena) {}
+
+template<typename Fn>
+Value json::BinaryParser<Fn>::bindKey(const String &key, const Value &v) {
+	if (key.empty()) return v.stripKey();
+	return PValue(new ObjectProxyString(key, v.getHandle()->unproxy()));
+}
 
 template<typename Fn>
 Value json::BinaryParser<Fn>::parseKey(unsigned char tag) {
@@ -246,6 +302,10 @@ Value json::BinaryParser<Fn>::parseArray(unsigned char tag, bool ) {
 	for (std::size_t i = 0; i < sz; i++) {
 		arr->push_back(parseItem().getHandle());
 	}
+	if (enableParsePackedArrays && sz >= PackedArray::minPackSize) {
+		PValue packed = PackedArray::pack(arr);
+		if (packed != nullptr) return packed;
+	}
 	return PValue::staticCast(arr);
 }
 
@@ -398,15 +458,14 @@ Value BinaryParser<Fn>::parseItem() {
 		}
 	case opcode::key: {
 		String s(parseString(tag, nullptr));
+		if (s.str().size() <= KeyTable::maxKeyLength) s = KeyTable::intern(s.str());
 		storeKey(s);
-		Value v = parseItem();
-		return Value(s, v);
+		return bindKey(s, parseItem());
 	}
 	default: {
 		unsigned int p = (keyIndex - 1 - tag) & 0x7F;
 		String s = p>=keyHistory.size()?String():keyHistory[p];
-		Value v = parseItem();
-		return Value(s,v);
+		return bindKey(s, parseItem());
 	}
 		
 	}
@@ -0,0 +1,49 @@
+#include <new>
+#include "chunkMap.h"
+
+namespace json {
+
+	std::atomic<bool> ChunkMap::inUse(false);
+	std::atomic<std::atomic<std::uint64_t> *> ChunkMap::map[ChunkMap::topSize];
+
+	std::atomic<std::uint64_t> *ChunkMap::getLeaf(std::uintptr_t top) {
+		std::atomic<std::uint64_t> *leaf = map[top].load(std::memory_order_acquire);
+		if (leaf == nullptr) {
+			std::size_t words = leafSize / 64;
+			std::atomic<std::uint64_t> *newLeaf = new std::atomic<std::uint64_t>[words];
+			for (std::size_t i = 0; i < words; i++) newLeaf[i].store(0, std::memory_order_relaxed);
+			//leaves are never released, someone else could be faster
+			if (map[top].compare_exchange_strong(leaf, newLeaf, std::memory_order_acq_rel)) {
+				leaf = newLeaf;
+			} else {
+				delete [] newLeaf;
+			}
+		}
+		return leaf;
+	}
+
+	void *ChunkMap::allocChunk(std::size_t size) {
+		size = (size + chunkSize - 1) & ~(chunkSize - 1);
+		void *chunk = ::operator new(size, std::align_val_t(chunkSize));
+		std::uintptr_t idx = reinterpret_cast<std::uintptr_t>(chunk) >> chunkShift;
+		std::uintptr_t top = idx >> leafShift;
+		if (top >= topSize) {
+			::operator delete(chunk, std::align_val_t(chunkSize));
+			return nullptr;
+		}
+		std::atomic<std::uint64_t> *leaf = getLeaf(top);
+		std::uintptr_t bit = idx & (leafSize - 1);
+		leaf[bit >> 6].fetch_or(std::uint64_t(1) << (bit & 63), std::memory_order_relaxed);
+		inUse.store(true, std::memory_order_relaxed);
+		return chunk;
+	}
+
+	void ChunkMap::freeChunk(void *chunk) {
+		std::uintptr_t idx = reinterpret_cast<std::uintptr_t>(chunk) >> chunkShift;
+		std::atomic<std::uint64_t> *leaf = map[idx >> leafShift].load(std::memory_order_acquire);
+		std::uintptr_t bit = idx & (leafSize - 1);
+		leaf[bit >> 6].fetch_and(~(std::uint64_t(1) << (bit & 63)), std::memory_order_relaxed);
+		::operator delete(chunk, std::align_val_t(chunkSize));
+	}
+
+}
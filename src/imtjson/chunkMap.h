@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace json {
+
+	///Header at the beginning of every chunk managed by a chunk allocator
+	/** Chunks are aligned to ChunkMap::chunkSize, so the header of any block
+	 * allocated inside of the chunk can be found by clearing lower bits of its address
+	 */
+	struct ChunkHeader {
+		///Function which releases a block allocated inside of the chunk
+		void (*release)(ChunkHeader *chunk, void *ptr);
+	};
+
+
+	///Registry of memory chunks owned by chunk allocators (for example Arena)
+	/** The deallocator uses the registry to find out, whether the pointer belongs
+	 * to a chunk allocator. It doesn't need to touch the memory of the block, so
+	 * it is safe to ask for any pointer, including the pointers allocated by the heap.
+	 *
+	 * The registry is two-level bitmap indexed by address of the chunk. Lookup
+	 * is lock-free and it costs two memory reads.
+	 */
+	class ChunkMap {
+	public:
+
+		static const unsigned int chunkShift = 16;
+		///Size and alignment of the chunk
+		static const std::size_t chunkSize = std::size_t(1) << chunkShift;
+
+		///Allocates and registers new chunk
+		/**
+		 * @param size size of the chunk in bytes. It is rounded up to multiple of chunkSize
+		 * @return pointer to the chunk (aligned to chunkSize), or nullptr, if the chunk
+		 * cannot be registered (address out of range). In this case, the caller
+		 * should fallback to standard allocator
+		 */
+		static void *allocChunk(std::size_t size);
+		///Unregisters and releases the chunk
+		/**
+		 * @param chunk pointer to chunk
+		 */
+		static void freeChunk(void *chunk);
+
+		///Finds header of the chunk which contains given pointer
+		/**
+		 * @param ptr pointer to test
+		 * @return pointer to chunk header, or nullptr if the pointer doesn't belong to any chunk
+		 */
+		static ChunkHeader *find(const void *ptr) {
+			if (!inUse.load(std::memory_order_relaxed)) return nullptr;
+			std::uintptr_t idx = reinterpret_cast<std::uintptr_t>(ptr) >> chunkShift;
+			std::uintptr_t top = idx >> leafShift;
+			if (top >= topSize) return nullptr;
+			const std::atomic<std::uint64_t> *leaf = map[top].load(std::memory_order_acquire);
+			if (leaf == nullptr) return nullptr;
+			std::uintptr_t bit = idx & (leafSize - 1);
+			if (leaf[bit >> 6].load(std::memory_order_relaxed) & (std::uint64_t(1) << (bit & 63))) {
+				return reinterpret_cast<ChunkHeader *>(idx << chunkShift);
+			}
+			return nullptr;
+		}
+
+	protected:
+		static const unsigned int leafShift = 16;
+		static const std::size_t leafSize = std::size_t(1) << leafShift;
+		static const std::size_t topSize = std::size_t(1) << 16;
+
+		static std::atomic<bool> inUse;
+		static std::atomic<std::atomic<std::uint64_t> *> map[topSize];
+
+		static std::atomic<std::uint64_t> *getLeaf(std::uintptr_t top);
+	};
+
+}
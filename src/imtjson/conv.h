@@ -128,11 +128,17 @@ public:
 template<typename T> class ConvValueFrom<std::vector<T> > {
 public:
 	static Value convert(const std::vector<T> &v) {
-		ValueBuilder bld(v.size());
-		for (auto &&k : v) {
-			bld.push_back(Value::from<T>(k));
+		if constexpr((std::is_arithmetic<T>::value && !std::is_same<T, bool>::value)
+				|| std::is_same<T, std::string>::value || std::is_same<T, std::string_view>::value) {
+			//numbers and strings are packed
+			return Value::packedArray(v.data(), v.size());
+		} else {
+			ValueBuilder bld(array, v.size());
+			for (auto &&k : v) {
+				bld.push_back(Value::from<T>(k));
+			}
+			return bld.commit();
 		}
-		return bld.commit();
 	}
 };
 
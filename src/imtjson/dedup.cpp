@@ -0,0 +1,159 @@
+#include <cstring>
+#include <vector>
+#include "dedup.h"
+#include "value.h"
+#include "abstractValue.h"
+#include "arrayValue.h"
+#include "objectValue.h"
+#include "smallObjectValue.h"
+#include "shapeValue.h"
+#include "packedArray.h"
+#include "stringValue.h"
+
+namespace json {
+
+	///Values with these flags have identity or they cannot be created again
+	static const ValueTypeFlags noDedupFlags = proxy | userDefined | customObject | valueDiff | serializedCached;
+
+	static bool canDedup(const IValue *v) {
+		return !v->isImmortal() && (v->flags() & noDedupFlags) == 0;
+	}
+
+	static std::size_t hashPtr(const IValue *v) {
+		return reinterpret_cast<std::uintptr_t>(v);
+	}
+
+	std::size_t DedupTable::Hash::operator()(const PValue &v) const {
+		ValueType t = v->type();
+		ValueTypeFlags f = v->flags();
+		std::size_t h = AbstractValue::hashCombine(AbstractValue::hashSeed(t), f);
+		switch (t) {
+			case string: return AbstractValue::hashCombine(h, AbstractValue::hashString(v->getString()));
+			case number: return AbstractValue::hashCombine(h, (f & preciseNumber)
+					?AbstractValue::hashString(v->getString())
+					:AbstractValue::hashNumber(v->getNumber()));
+			case array: {
+				if (f & (packedNumbers|packedStrings)) return AbstractValue::hashCombine(h, v->hash());
+				std::size_t cnt = v->size();
+				for (std::size_t i = 0; i < cnt; i++) h = AbstractValue::hashCombine(h, hashPtr(ItemRef(v, i)));
+				return h;
+			}
+			case object: {
+				std::size_t cnt = v->size();
+				for (std::size_t i = 0; i < cnt; i++) {
+					ItemRef item(v, i);
+					h = AbstractValue::hashCombine(h, AbstractValue::hashString(item.getMemberName()));
+					h = AbstractValue::hashCombine(h, hashPtr(item));
+				}
+				return h;
+			}
+			default: return AbstractValue::hashCombine(h, v->getBool()?1:0);
+		}
+	}
+
+	template<typename T>
+	static bool samePacked(const IValue *a, const IValue *b, bool &res) {
+		const PackedArrayValue<T> *pa = PackedArrayValue<T>::cast(a);
+		if (pa == nullptr) return false;
+		const PackedArrayValue<T> *pb = PackedArrayValue<T>::cast(b);
+		//compare bytes, 0.0 and -0.0 are not the same
+		res = pb != nullptr && std::memcmp(pa->data(), pb->data(), a->size() * sizeof(T)) == 0;
+		return true;
+	}
+
+	bool DedupTable::Equal::operator()(const PValue &a, const PValue &b) const {
+		if (a == b) return true;
+		ValueType t = a->type();
+		ValueTypeFlags f = a->flags();
+		if (t != b->type() || f != b->flags() || a->size() != b->size()) return false;
+		switch (t) {
+			case string:
+				return a->getString() == b->getString()
+						&& StringValue::getEncoding(a) == StringValue::getEncoding(b);
+			case number:
+				if (f & preciseNumber) return a->getString() == b->getString();
+				if (f & numberUnsignedInteger) return a->getUIntLong() == b->getUIntLong();
+				if (f & numberInteger) return a->getIntLong() == b->getIntLong();
+				{
+					double x = a->getNumber(), y = b->getNumber();
+					return std::memcmp(&x, &y, sizeof(x)) == 0;
+				}
+			case array: {
+				bool res;
+				if (samePacked<double>(a, b, res) || samePacked<LongInt>(a, b, res) || samePacked<ULongInt>(a, b, res))
+					return res;
+				if (f & packedStrings) return a->equal(b);
+				std::size_t cnt = a->size();
+				for (std::size_t i = 0; i < cnt; i++) {
+					if (ItemRef(a, i).get() != ItemRef(b, i).get()) return false;
+				}
+				return true;
+			}
+			case object: {
+				std::size_t cnt = a->size();
+				for (std::size_t i = 0; i < cnt; i++) {
+					ItemRef ia(a, i);
+					ItemRef ib(b, i);
+					if (ia.get() != ib.get() || ia.getMemberName() != ib.getMemberName()) return false;
+				}
+				return true;
+			}
+			default: return a->getBool() == b->getBool();
+		}
+	}
+
+	PValue DedupTable::intern(const PValue &v) {
+		if (!canDedup(v)) return v;
+		return *values.insert(v).first;
+	}
+
+	PValue DedupTable::dedup(const PValue &v) {
+		if (!canDedup(v)) return v;
+		ValueType t = v->type();
+		ValueTypeFlags f = v->flags();
+		if ((t == array && (f & (packedNumbers|packedStrings)) == 0) || t == object) {
+			std::size_t cnt = v->size();
+			std::vector<PValue> items;
+			items.reserve(cnt);
+			bool changed = false;
+			for (std::size_t i = 0; i < cnt; i++) {
+				ItemRef ref(v, i);
+				const IValue *item = ref->unproxy();
+				items.push_back(dedup(item));
+				changed = changed || static_cast<const IValue *>(items.back()) != item;
+			}
+			if (changed) {
+				if (t == array) {
+					RefCntPtr<ArrayValue> res = ArrayValue::create(cnt);
+					for (const PValue &x: items) res->push_back(x);
+					return intern(PValue(res));
+				}
+				const ShapeObjectValue *sh = dynamic_cast<const ShapeObjectValue *>(v.operator->());
+				if (sh) {
+					RefCntPtr<ShapeObjectValue> res = ShapeObjectValue::create(sh->getShape());
+					for (const PValue &x: items) res->push_back(x);
+					return intern(PValue(res));
+				}
+				if (cnt <= SmallObjectValue::maxMembers) {
+					RefCntPtr<SmallObjectValue> res = SmallObjectValue::create(cnt);
+					for (std::size_t i = 0; i < cnt; i++) res->push_back(ObjectEntry(ObjectEntry::fromMember(v, i).key, items[i]));
+					res->sort();
+					return intern(PValue(res));
+				}
+				RefCntPtr<ObjectValue> res = ObjectValue::create(cnt);
+				for (std::size_t i = 0; i < cnt; i++) res->push_back(ObjectEntry(ObjectEntry::fromMember(v, i).key, items[i]));
+				res->sort();
+				return intern(PValue(res));
+			}
+		}
+		return intern(v);
+	}
+
+	Value Value::dedup() const {
+		DedupTable table;
+		Value res(table.dedup(v->unproxy()));
+		if (flags() & proxy) return Value(getKey(), res);
+		else return res;
+	}
+
+}
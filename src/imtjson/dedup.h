@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_set>
+#include "ivalue.h"
+
+namespace json {
+
+	///Table of canonical values, which allows to share equal subtrees
+	/** Every value put into the table is replaced by the first equal value
+	 * already stored in the table. Containers are compared by identity of their items,
+	 * so items must be put into the table before the container (bottom-up). This makes the
+	 * lookup cheap even for large subtrees.
+	 *
+	 * Values are considered equal only if they are serialized the same way, so
+	 * for example 1 and 1.0 are not merged.
+	 *
+	 * The table is used by Value::dedup() and by the parser with the flag dedupValues. It
+	 * holds references to all stored values, so it should be destroyed when the
+	 * deduplication is finished
+	 */
+	class DedupTable {
+	public:
+
+		///Retrieves canonical value
+		/**
+		 * @param v value. Items of a container should be already canonical.
+		 * @return canonical value equal to the given value. If there is no such value, the
+		 * given value is stored and returned. Values with a key, custom objects and immortal
+		 * values are returned unchanged
+		 */
+		PValue intern(const PValue &v);
+		///Deduplicates whole tree
+		/**
+		 * @param v root of the tree (without a key)
+		 * @return canonical tree. Containers with items replaced by the canonical items are
+		 * created again
+		 */
+		PValue dedup(const PValue &v);
+
+		///Count of values in the table
+		std::size_t size() const {return values.size();}
+
+	protected:
+		struct Hash {
+			std::size_t operator()(const PValue &v) const;
+		};
+		struct Equal {
+			bool operator()(const PValue &a, const PValue &b) const;
+		};
+
+		std::unordered_set<PValue, Hash, Equal> values;
+	};
+
+}
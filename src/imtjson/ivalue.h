@@ -5,6 +5,7 @@
 
 #include "refcnt.h"
 #include "allocator.h"
+#include "localtree.h"
 namespace json {
 
 	using Int = long int;
@@ -130,6 +131,34 @@ namespace json {
 	///States, that object is long integer 64bit number. It is used only in 32bit environment
 	const ValueTypeFlags longInt = 256;
 
+	///States, that array stores numbers packed in a contiguous memory
+	/** This flag appears with an array only. The flags of the array don't describe the items,
+	 * the type of the items is retrieved by Value::getPackedItemFlags(). The items are
+	 * stored as double, if none of numberInteger and numberUnsignedInteger is present
+	 *
+	 * @see Value::getPacked, Value::getPackedItemFlags
+	 */
+	const ValueTypeFlags packedNumbers = 512;
+
+	///States, that array stores strings packed in a single buffer
+	/** This flag appears with an array only.
+	 *
+	 * @see Value::getPackedStrings
+	 */
+	const ValueTypeFlags packedStrings = 1024;
+
+	///States, that string can be serialized as it is
+	/** The string contains printable ASCII characters only and none of them
+	 * needs to be escaped. The flag is determined once when the string is created, the
+	 * serializer then writes such string without examining its characters. On a packed array
+	 * of strings, the flag states that all strings of the array are plain.
+	 */
+	const ValueTypeFlags plainString = 2048;
+
+	///States, that container remembers its serialized text
+	/** @see Value::cacheSerialized, SerializedCache */
+	const ValueTypeFlags serializedCached = 4096;
+
 
 	typedef int BinarySerializeFlags;
 
@@ -194,6 +223,9 @@ namespace json {
 	///Interface access internal value of JSON Value
 	class IValue: public RefCntObj, public AllocObject {
 	public:
+		IValue() {
+			if (LocalTreeScope::isActive()) setLocal();
+		}
 		virtual ~IValue() {}
 
 		virtual ValueType type() const = 0;
@@ -218,6 +250,76 @@ namespace json {
 		virtual bool equal(const IValue *other) const = 0;
 
 		virtual int compare(const IValue * other) const = 0;
+
+		///Enumerates all values directly referenced by this value
+		/** This includes items of containers as well as values held internally (for
+		 * example parent of a substring). It is used by functions which need
+		 * to process whole graph of values, such a Value::publish()
+		 *
+		 * @param fn function called for every referenced value
+		 * @retval true enumeration finished
+		 * @retval false enumeration was stopped by the function
+		 */
+		virtual bool forEachRef(const IEnumFn &fn) const {(void)fn; return true;}
+
+		///Retrieves item at index without taking a reference
+		/**
+		 * @param index index of the item
+		 * @return pointer to the item. The pointer is valid as long as this value exists.
+		 * Returns undefined value, if the index is out of range. Returns nullptr, if the
+		 * value doesn't keep its items, use itemAtIndex() in this case
+		 *
+		 * @note default implementation returns nullptr. Containers which keep their items
+		 * should override this function. To visit items of any container, use ItemRef
+		 */
+		virtual const IValue *borrowAtIndex(std::size_t index) const {(void)index; return nullptr;}
+		///Retrieves member without taking a reference
+		/**
+		 * @param name name of the member
+		 * @return pointer to the member. The pointer is valid as long as this value exists.
+		 * Returns undefined value, if the member doesn't exist. Returns nullptr, if the
+		 * value doesn't keep its items, use member() in this case
+		 *
+		 * @note default implementation returns nullptr, see borrowAtIndex()
+		 */
+		virtual const IValue *borrowMember(const std::string_view &name) const {(void)name; return nullptr;}
+		///Retrieves name of the member at index
+		/**
+		 * @param index index of the member
+		 * @return name of the member. The name is valid as long as this value exists. For
+		 * values other than objects, it returns empty string
+		 *
+		 * @note default implementation uses borrowAtIndex(). If the value doesn't keep its
+		 * items, it returns empty string, ItemRef::getMemberName() handles this case
+		 */
+		virtual StringView memberNameAtIndex(std::size_t index) const {
+			const IValue *v = borrowAtIndex(index);
+			return v?v->getMemberName():StringView();
+		}
+
+		///Retrieves key of the member at index as a value
+		/** Objects which store keys as string values return them, so the caller can
+		 * access flags of the key (for example plainString)
+		 *
+		 * @param index index of the member
+		 * @return key of the member, or nullptr, if the key is not available as a value
+		 */
+		virtual const IValue *memberKeyAtIndex(std::size_t index) const {(void)index; return nullptr;}
+
+		///Calculates structural hash of the value
+		/** Equal values (see equal()) have equal hash. The key of the value is not
+		 * included. Containers calculate the hash once and keep it
+		 */
+		virtual std::size_t hash() const;
+		///Retrieves the hash, if it has been already calculated
+		/** @return the hash, or zero, if the hash is not available without calculation */
+		virtual std::size_t cachedHash() const {return 0;}
+
+		///Retrieves count of bytes allocated by the value
+		/** Referenced values are not included, see Value::memoryUsage()
+		 * @note default implementation returns size of the interface only. Values which
+		 * are larger should override this function */
+		virtual std::size_t memorySize() const {return sizeof(IValue);}
 	};
 
 	class IEnumFn {
@@ -226,6 +328,44 @@ namespace json {
 		virtual bool operator()(const IValue *v) const = 0;
 	};
 
+	///Item of a container, which is borrowed, if possible
+	/** The container borrows the item, when it supports borrowAtIndex(). Otherwise, the
+	 * item is retrieved by itemAtIndex() and the reference is held by this object. The
+	 * pointer is valid as long as this object and the container exist
+	 */
+	class ItemRef {
+	public:
+		ItemRef(const IValue *container, std::size_t index)
+			:ptr(container->borrowAtIndex(index)),container(container),index(index) {
+			if (!ptr) ptr = hold = container->itemAtIndex(index);
+		}
+
+		const IValue *get() const {return ptr;}
+		const IValue *operator->() const {return ptr;}
+		operator const IValue *() const {return ptr;}
+
+		///Retrieves name of the member
+		StringView getMemberName() const {
+			return hold?hold->getMemberName():container->memberNameAtIndex(index);
+		}
+
+	protected:
+		const IValue *ptr;
+		RefCntPtr<const IValue> hold;
+		const IValue *container;
+		std::size_t index;
+	};
+
+	///Converts a function to IEnumFn
+	template<typename Fn>
+	class EnumFn: public IEnumFn {
+	public:
+		EnumFn(Fn &&fn):fn(std::forward<Fn>(fn)) {}
+		virtual bool operator()(const IValue *v) const override {return fn(v);}
+	protected:
+		Fn fn;
+	};
+
 
 
 }
@@ -22,13 +22,13 @@ ObjectProxy::ObjectProxy(const std::string_view &name, const PValue &value):Abst
 
 void *ObjectProxy::operator new(std::size_t sz, const std::string_view &str ) {
 	std::size_t needsz = sz - sizeof(ObjectProxy::key) + str.size()+1;
-	return Value::allocator->alloc(needsz);
+	return Allocator::getInstance()->alloc(needsz);
 }
 void ObjectProxy::operator delete(void *ptr, const std::string_view &) {
-	Value::allocator->dealloc(ptr);
+	Allocator::getInstance()->dealloc(ptr);
 }
 void ObjectProxy::operator delete(void *ptr, std::size_t ) {
-	Value::allocator->dealloc(ptr);
+	Allocator::getInstance()->dealloc(ptr);
 }
 
 
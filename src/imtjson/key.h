@@ -32,9 +32,17 @@ public:
 	virtual std::size_t size() const override { return value->size(); }
 	virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const override { return value->itemAtIndex(index); }
 	virtual RefCntPtr<const IValue> member(const std::string_view &name) const override { return value->member(name); }
+	virtual const IValue *borrowAtIndex(std::size_t index) const override { return value->borrowAtIndex(index); }
+	virtual const IValue *borrowMember(const std::string_view &name) const override { return value->borrowMember(name); }
+	virtual StringView memberNameAtIndex(std::size_t index) const override { return value->memberNameAtIndex(index); }
+	virtual const IValue *memberKeyAtIndex(std::size_t index) const override { return value->memberKeyAtIndex(index); }
 	virtual StringView getMemberName() const override { return value->getMemberName(); }
 	virtual const IValue *unproxy() const override { return value->unproxy(); }
 	virtual bool equal(const IValue *other) const override {return value->equal(other->unproxy());}
+	virtual bool forEachRef(const IEnumFn &fn) const override {return fn(value);}
+	virtual std::size_t hash() const override {return value->hash();}
+	virtual std::size_t cachedHash() const override {return value->cachedHash();}
+	virtual std::size_t memorySize() const override {return sizeof(AbstractProxy);}
 
 protected:
 	PValue value;
@@ -47,6 +55,7 @@ public:
 
 	ObjectProxy(const std::string_view &name, const PValue &value);
 	virtual StringView getMemberName() const override { return StringView(key,keysize); }
+	virtual std::size_t memorySize() const override {return sizeof(ObjectProxy) - sizeof(key) + keysize + 1;}
 
 	void *operator new(std::size_t sz, const std::string_view &str );
 	void operator delete(void *ptr, const std::string_view &str);
@@ -64,6 +73,8 @@ public:
 
 	virtual StringView getMemberName() const override { return StringView(key.str()); }
 	const String getKey() const {return key;}
+	virtual bool forEachRef(const IEnumFn &fn) const override {return fn(value) && fn(key.getHandle());}
+	virtual std::size_t memorySize() const override {return sizeof(ObjectProxyString);}
 protected:
 	String key;
 
@@ -0,0 +1,72 @@
+#include <mutex>
+#include <unordered_map>
+#include "keyTable.h"
+#include "value.h"
+#include "arena.h"
+
+namespace json {
+
+	///Table is split to shards to reduce lock contention
+	static const std::size_t shardCount = 16;
+	///Minimal size of the shard before it is swept
+	static const std::size_t minSweepSize = 256;
+
+	struct KeyShard {
+		std::mutex lock;
+		///Key view refers to the content of the interned string
+		std::unordered_map<std::string_view, PValue> keys;
+		std::size_t sweepSize = minSweepSize;
+
+		void sweep() {
+			for (auto iter = keys.begin(); iter != keys.end();) {
+				//the table holds the only reference. Nobody else can add a reference without the lock
+				if (iter->second.use_count() == 1) iter = keys.erase(iter);
+				else ++iter;
+			}
+			sweepSize = std::max(minSweepSize, keys.size() * 2);
+		}
+	};
+
+	///Shards are never destroyed, so keys can be interned during the exit of the program
+	static KeyShard *getShards() {
+		static KeyShard *shards = new KeyShard[shardCount];
+		return shards;
+	}
+
+	String KeyTable::intern(const std::string_view &key) {
+		if (key.size() > maxKeyLength) return String(key);
+		std::size_t h = std::hash<std::string_view>()(key);
+		KeyShard &shard = getShards()[h % shardCount];
+		std::lock_guard<std::mutex> _(shard.lock);
+		auto iter = shard.keys.find(key);
+		if (iter != shard.keys.end()) return String(Value(iter->second));
+		if (shard.keys.size() >= shard.sweepSize) shard.sweep();
+		PValue str;
+		{
+			ArenaSuspend noArena;
+			str = String(key).getHandle();
+		}
+		str->publish();
+		shard.keys.emplace(str->getString(), str);
+		return String(Value(str));
+	}
+
+	void KeyTable::sweep() {
+		KeyShard *shards = getShards();
+		for (std::size_t i = 0; i < shardCount; i++) {
+			std::lock_guard<std::mutex> _(shards[i].lock);
+			shards[i].sweep();
+		}
+	}
+
+	std::size_t KeyTable::size() {
+		KeyShard *shards = getShards();
+		std::size_t cnt = 0;
+		for (std::size_t i = 0; i < shardCount; i++) {
+			std::lock_guard<std::mutex> _(shards[i].lock);
+			cnt += shards[i].keys.size();
+		}
+		return cnt;
+	}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include "string.h"
+
+namespace json {
+
+	///Process-wide table of interned keys
+	/** Keys of the objects are interned, so equal keys share one string value regardless
+	 * of which document or which thread created them. Documents with repeating structure
+	 * (arrays of records, cached API responses) store each key name only once.
+	 *
+	 * The table holds a reference to every interned key. Keys which are no longer used
+	 * by any value are removed from the table when the table grows (see sweep()).
+	 *
+	 * Interned keys are never allocated in an arena and they are never thread local,
+	 * so they can be shared by any tree
+	 *
+	 * @note Keys longer than maxKeyLength are not interned
+	 */
+	class KeyTable {
+	public:
+
+		///Longest key which is interned
+		static const std::size_t maxKeyLength = 64;
+
+		///Retrieves interned key
+		/**
+		 * @param key key name
+		 * @return string value of the key. Equal keys return the same string value (unless
+		 * the key is too long)
+		 */
+		static String intern(const std::string_view &key);
+
+		///Removes keys which are not used anymore
+		static void sweep();
+
+		///Retrieves count of keys in the table
+		static std::size_t size();
+	};
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+namespace json {
+
+	///Marks values created by the current thread as thread local
+	/** While the scope is active, every value created by the current thread is marked
+	 * as thread local. References to such values are counted without atomic operations,
+	 * which speeds up building and walking of the trees, which are never shared with other
+	 * threads.
+	 *
+	 * Thread local values must not be accessed by other threads. If the result
+	 * needs to be shared, call Value::publish() before it is passed to other thread.
+	 *
+	 * @code
+	 * Value result;
+	 * {
+	 *    LocalTreeScope scope;
+	 *    result = process(Value::fromString(text));
+	 * }
+	 * sendToOtherThread(result.publish());
+	 * @endcode
+	 *
+	 * Scopes can be nested.
+	 */
+	class LocalTreeScope {
+	public:
+		LocalTreeScope() {++level;}
+		~LocalTreeScope() {--level;}
+		LocalTreeScope(const LocalTreeScope &) = delete;
+		LocalTreeScope &operator=(const LocalTreeScope &) = delete;
+
+		///Returns true, if the scope is active for the current thread
+		static bool isActive() {return level != 0;}
+
+	protected:
+		static thread_local unsigned int level;
+	};
+
+}
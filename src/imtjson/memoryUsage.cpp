@@ -0,0 +1,68 @@
+#include <unordered_map>
+#include <vector>
+#include "value.h"
+
+namespace json {
+
+	struct MemoryUsageNode {
+		///references from the inside of the tree
+		long refs = 0;
+		///node is reachable from the outside of the tree
+		bool external = false;
+	};
+
+	MemoryUsage Value::memoryUsage() const {
+		MemoryUsage res;
+		const IValue *root = v;
+		std::unordered_map<const IValue *, MemoryUsageNode> nodes;
+		std::vector<const IValue *> stack;
+
+		//first pass - collect nodes and count references between them
+		//the root is referenced by this variable
+		nodes[root].refs = 1;
+		stack.push_back(root);
+		while (!stack.empty()) {
+			const IValue *x = stack.back();
+			stack.pop_back();
+			x->forEachRef(EnumFn([&](const IValue *item){
+				MemoryUsageNode &nd = nodes[item];
+				if (nd.refs++ == 0) stack.push_back(item);
+				return true;
+			}));
+		}
+
+		//second pass - nodes with references from outside mark their content as external
+		for (auto &n: nodes) {
+			if (!n.second.external && (n.first->isImmortal() || n.first->use_count() > n.second.refs)) {
+				n.second.external = true;
+				stack.push_back(n.first);
+			}
+		}
+		while (!stack.empty()) {
+			const IValue *x = stack.back();
+			stack.pop_back();
+			x->forEachRef(EnumFn([&](const IValue *item){
+				MemoryUsageNode &nd = nodes[item];
+				if (!nd.external) {
+					nd.external = true;
+					stack.push_back(item);
+				}
+				return true;
+			}));
+		}
+
+		for (const auto &n: nodes) {
+			std::size_t sz = n.first->memorySize();
+			ValueType t = n.first->type();
+			res.count++;
+			res.total += sz;
+			res.byType[t] += sz;
+			if (!n.second.external) {
+				res.unique += sz;
+				res.uniqueByType[t] += sz;
+			}
+		}
+		return res;
+	}
+
+}
@@ -7,6 +7,8 @@
 #include "operations.h"
 #include "key.h"
 #include "path.h"
+#include "keyTable.h"
+#include "smallObjectValue.h"
 
 namespace json {
 
@@ -17,7 +19,7 @@ namespace json {
 		}else if (key == value->getMemberName()) {
 			return value;
 		}else {
-			return new(key) ObjectProxy(key, value->unproxy());
+			return new ObjectProxyString(KeyTable::intern(key), value->unproxy());
 		}
 	}
 
@@ -73,7 +75,7 @@ namespace json {
 	}
 
 
-void Object::set_internal(const Value& v) {
+void Object::set_internal(const ObjectEntry& v) {
 //	std::string_view curName = v.getKey();
 	lastIterSnapshot = Value();
 
@@ -81,35 +83,23 @@ void Object::set_internal(const Value& v) {
 		unordered = ObjectValue::create(ordered?ordered->size():8);
 	}
 
-	bool ok = unordered->push_back(v.getHandle());
+	bool ok = unordered->push_back(v);
 	if (!ok) {
 		RefCntPtr<ObjectValue> newcont (ObjectValue::create(unordered->size()*2));
 		optimize();
 		unordered = newcont;
-		unordered->push_back(v.getHandle());
+		unordered->push_back(v);
 	}
 }
 
 	void Object::set(const std::string_view& name, const Value & value)
 	{
-		PValue v = value.getHandle();
-		if (v->flags() & proxy ) {
-			std::string_view curName = v->getMemberName();
-			if (curName == name) {
-				set_internal(v);
-			} else {
-				v = v->unproxy();
-			}
-
-		}
-		v = new(name) ObjectProxy(name, v);
-		set_internal(v);
-
+		set_internal(ObjectEntry(KeyTable::intern(name).getHandle(), value.getHandle()->unproxy()));
 	}
 
 	void Object::set(const Value & value)
 	{
-		set_internal(value.getHandle());
+		set_internal(ObjectEntry::fromItem(value.getHandle()));
 	}
 
 	void Object::unset(const std::string_view& name)
@@ -126,13 +116,13 @@ void Object::set_internal(const Value& v) {
 				usz = 0;
 			}
 			for (std::size_t i = usz; i>0; i--) {
-				const PValue &z = (*unordered)[i-1];
-				if (z->getMemberName() == name) return z;
+				const ObjectEntry &z = (*unordered)[i-1];
+				if (z.getKey() == name) return z.toItem();
 			}
 		}
 		if (ordered != nullptr) {
-			const IValue *f = ordered->findSorted(name);
-			if (f) return f;
+			const ObjectEntry *f = ordered->findEntry(name);
+			if (f) return f->toItem();
 		}
 
 		return base[name];
@@ -150,8 +140,8 @@ void Object::set_internal(const Value& v) {
 		auto be = back.end();
 		auto fe = front.end();
 		while (bi != be && fi != fe) {
-			auto kf = (*fi)->getMemberName();
-			auto kb = (*bi)->getMemberName();
+			auto kf = fi->getKey();
+			auto kb = bi->getKey();
 			if (kf < kb) {
 				out->push_back(*fi);
 				++fi;
@@ -176,33 +166,39 @@ void Object::set_internal(const Value& v) {
 		return out;
 	}
 
-	static RefCntPtr<ObjectValue> mergeObjects(const ObjectValue &back, const ObjectValue &front) {
-		RefCntPtr<ObjectValue> out = ObjectValue::create(back.size()+front.size());
-		auto bi = back.begin();
+	static RefCntPtr<ObjectValue> mergeObjects(const IValue *back, const ObjectValue &front) {
+		std::size_t bcnt = back->size();
+		RefCntPtr<ObjectValue> out = ObjectValue::create(bcnt+front.size());
+		auto pushBack = [&](std::size_t i) {
+			if (ItemRef(back, i)->type() != json::undefined) {
+				out->push_back(ObjectEntry::fromMember(back, i));
+			}
+		};
+		std::size_t bi = 0;
 		auto fi = front.begin();
-		auto be = back.end();
 		auto fe = front.end();
-		while (bi != be && fi != fe) {
-			auto kf = (*fi)->getMemberName();
-			auto kb = (*bi)->getMemberName();
+		while (bi != bcnt && fi != fe) {
+			auto kf = fi->getKey();
+			ItemRef bitem(back, bi);
+			auto kb = bitem.getMemberName();
 			if (kf < kb) {
-				if ((*fi)->type() != json::undefined) out->push_back(*fi);
+				if (fi->value->type() != json::undefined) out->push_back(*fi);
 				++fi;
 			} else if (kf > kb) {
-				if ((*bi)->type() != json::undefined) out->push_back(*bi);
+				pushBack(bi);
 				++bi;
 			} else {
-				if ((*fi)->type() != json::undefined) out->push_back(*fi);
+				if (fi->value->type() != json::undefined) out->push_back(*fi);
 				++fi;
 				++bi;
 			}
 		}
-		while (bi != be) {
-			if ((*bi)->type() != json::undefined) out->push_back(*bi);
+		while (bi != bcnt) {
+			pushBack(bi);
 			++bi;
 		}
 		while (fi != fe) {
-			if ((*fi)->type() != json::undefined) out->push_back(*fi);
+			if (fi->value->type() != json::undefined) out->push_back(*fi);
 			++fi;
 		}
 		out->isDiff = false;
@@ -229,12 +225,13 @@ void Object::set_internal(const Value& v) {
 		if (ordered == nullptr) {
 			return base.v;
 		} else {
-			const ObjectValue *oval = dynamic_cast<const ObjectValue *>(static_cast<const IValue *>(base.getHandle()->unproxy()));
-			RefCntPtr<ObjectValue> res;
-			if (oval == nullptr) {
-				res = mergeObjects(ObjectValue(),*ordered);
-			} else {
-				res = mergeObjects(*oval,*ordered);
+			const IValue *bval = base.getHandle()->unproxy();
+			if (bval->type() != json::object) bval = AbstractObjectValue::getEmptyObject();
+			RefCntPtr<ObjectValue> res = mergeObjects(bval,*ordered);
+			if (res->size() <= SmallObjectValue::maxMembers) {
+				RefCntPtr<SmallObjectValue> sobj = SmallObjectValue::create(res->size());
+				for (const ObjectEntry &e: *res) sobj->push_back(e);
+				return PValue(sobj);
 			}
 			return PValue(res);
 		}
@@ -348,16 +345,23 @@ Object::Object(Object &&other)
 
 Value::Value(const std::string_view key, const Value &value) :v(bindKeyToPValue(key, value.getHandle())) {}
 
-Object::Object(const std::initializer_list<std::pair<std::string_view, Value> > &fields) {
-	auto obj = ObjectValue::create(fields.size());
+template<typename T>
+static PValue createFromFields(const std::initializer_list<std::pair<std::string_view, Value> > &fields, RefCntPtr<T> obj) {
 	for (const auto &x: fields) {
 		if (x.second.defined()) {
-			obj->push_back(bindKeyToPValue(x.first, x.second.getHandle()));
+			obj->push_back(ObjectEntry(KeyTable::intern(x.first).getHandle(), x.second.getHandle()->unproxy()));
 		}
 	}
 	obj->sort();
-	base = PValue(obj);
+	return PValue(obj);
+}
 
+Object::Object(const std::initializer_list<std::pair<std::string_view, Value> > &fields) {
+	if (fields.size() <= SmallObjectValue::maxMembers) {
+		base = createFromFields(fields, SmallObjectValue::create(fields.size()));
+	} else {
+		base = createFromFields(fields, ObjectValue::create(fields.size()));
+	}
 }
 
 
@@ -15,6 +15,7 @@ namespace json {
 
 	class ObjectValue;
 	class ObjectDiff;
+	struct ObjectEntry;
 
 	///The class helps to build JSON object
 	/** To build or modify JSON object, construct this class. Then you can add, remove
@@ -240,7 +241,7 @@ namespace json {
 
 
 private:
-	void set_internal(const Value& v);
+	void set_internal(const ObjectEntry& v);
 };
 
 
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+	///Lookup index of the keys of an object or of a shape
+	/** Keys are copied to side arrays (prefixes, lengths, pointers), so the binary search
+	 * doesn't need to touch the entries and the string values of the keys. Large objects
+	 * have also a hash table (open addressing, linear probing)
+	 */
+	struct ObjectIndex {
+		///Slot of the hash table
+		/** The slot keeps also the pointer and the length of the key, so a lookup
+		 * touches only the slot and the text of the key */
+		struct Slot {
+			const char *key;
+			///upper 16 bits of the hash (lower bits select the slot)
+			std::uint16_t hash;
+			///length of the key, or maxSlotLength for longer keys
+			std::uint16_t length;
+			///index of the entry + 1, zero is empty slot
+			std::uint32_t entry;
+		};
+		static const std::size_t maxSlotLength = 0xFFFF;
+
+		///count of indexed entries
+		std::size_t count = 0;
+		///first 8 bytes of the keys (big endian, zero padded) - they are compared as numbers
+		std::vector<std::uint64_t> prefix;
+		std::vector<std::uint32_t> length;
+		std::vector<const char *> keys;
+		std::size_t mask = 0;
+		///hash table, empty for smaller objects
+		std::vector<Slot> slots;
+
+		///FNV-1a, 32 bit
+		static std::uint32_t hash(const std::string_view &name) {
+			std::uint32_t h = 2166136261U;
+			for (char c: name) h = (h ^ static_cast<unsigned char>(c)) * 16777619U;
+			return h;
+		}
+
+		static std::uint64_t makePrefix(const std::string_view &name) {
+			std::uint64_t p = 0;
+			std::size_t n = std::min<std::size_t>(name.size(), 8);
+			for (std::size_t i = 0; i < 8; i++) {
+				p = (p << 8) | (i < n?static_cast<unsigned char>(name[i]):0);
+			}
+			return p;
+		}
+
+		///Builds the index
+		/**
+		 * @param cnt count of keys
+		 * @param getKey function which returns key at given index. Keys must be sorted and
+		 * they must exist while the index is used
+		 * @param hashed build also the hash table
+		 */
+		template<typename Fn>
+		void build(std::size_t cnt, Fn &&getKey, bool hashed) {
+			count = cnt;
+			prefix.reserve(cnt);
+			length.reserve(cnt);
+			keys.reserve(cnt);
+			for (std::size_t i = 0; i < cnt; i++) {
+				std::string_view k = getKey(i);
+				prefix.push_back(makePrefix(k));
+				length.push_back(static_cast<std::uint32_t>(k.size()));
+				keys.push_back(k.data());
+			}
+			if (hashed) {
+				std::size_t cap = 16;
+				while (cap < cnt * 2) cap <<= 1;
+				mask = cap - 1;
+				slots.resize(cap, Slot{nullptr,0,0,0});
+				for (std::size_t i = 0; i < cnt; i++) {
+					std::uint32_t h = hash(std::string_view(keys[i], length[i]));
+					std::size_t p = h & mask;
+					while (slots[p].entry) p = (p + 1) & mask;
+					slots[p] = Slot{keys[i], static_cast<std::uint16_t>(h >> 16), slotLength(length[i]), static_cast<std::uint32_t>(i + 1)};
+				}
+			}
+		}
+
+		///Returns index of the entry, or count if not found
+		std::size_t find(const std::string_view &name) const {
+			return slots.empty()?findSorted(name):findHashed(name);
+		}
+
+		///Retrieves count of bytes allocated by the side arrays
+		std::size_t memorySize() const {
+			return prefix.capacity() * sizeof(std::uint64_t)
+				+ length.capacity() * sizeof(std::uint32_t)
+				+ keys.capacity() * sizeof(const char *)
+				+ slots.capacity() * sizeof(Slot);
+		}
+
+		///Returns index of the entry, or count if not found
+		std::size_t findSorted(const std::string_view &name) const {
+			std::uint64_t np = makePrefix(name);
+			std::size_t l = 0;
+			std::size_t r = count;
+			while (l < r) {
+				std::size_t m = (l + r) / 2;
+				std::uint64_t kp = prefix[m];
+				int c;
+				if (np != kp) c = np < kp?-1:1;
+				else if (name.size() <= 8 && length[m] <= 8) c = name.size() < length[m]?-1:name.size() > length[m]?1:0;
+				else c = name.compare(std::string_view(keys[m], length[m]));
+				if (c > 0) {
+					l = m + 1;
+				}
+				else if (c < 0) {
+					r = m;
+				}
+				else {
+					return m;
+				}
+			}
+			return count;
+		}
+
+		///Returns index of the entry, or count if not found
+		std::size_t findHashed(const std::string_view &name) const {
+			std::uint32_t h = hash(name);
+			std::uint16_t hh = static_cast<std::uint16_t>(h >> 16);
+			std::uint16_t ln = slotLength(name.size());
+			std::size_t p = h & mask;
+			while (slots[p].entry) {
+				const Slot &s = slots[p];
+				if (s.hash == hh && s.length == ln) {
+					std::size_t i = s.entry - 1;
+					//empty keys can have no data
+					if ((ln < maxSlotLength || length[i] == name.size())
+							&& (name.empty() || std::memcmp(s.key, name.data(), name.size()) == 0)) return i;
+				}
+				p = (p + 1) & mask;
+			}
+			return count;
+		}
+
+		static std::uint16_t slotLength(std::size_t len) {
+			return static_cast<std::uint16_t>(len < maxSlotLength?len:maxSlotLength);
+		}
+
+	};
+
+}
@@ -1,10 +1,81 @@
 #include "objectValue.h"
+#include "objectIndex.h"
+#include "key.h"
+#include "keyTable.h"
+#include "shapeValue.h"
+#include "smallObjectValue.h"
 
 #include <algorithm>
+#include <cstring>
 namespace json {
 
 
+	ObjectEntry ObjectEntry::fromItem(const PValue &item) {
+		if (item->flags() & proxy) {
+			const ObjectProxyString *str = dynamic_cast<const ObjectProxyString *>(static_cast<const IValue *>(item));
+			if (str) return ObjectEntry(str->getKey().getHandle(), item->unproxy());
+		}
+		return ObjectEntry(KeyTable::intern(item->getMemberName()).getHandle(), item->unproxy());
+	}
+
+	ObjectEntry ObjectEntry::fromMember(const IValue *obj, std::size_t index) {
+		const ObjectValue *oval = dynamic_cast<const ObjectValue *>(obj);
+		if (oval) return (*oval)[index];
+		const SmallObjectValue *smval = dynamic_cast<const SmallObjectValue *>(obj);
+		if (smval) return (*smval)[index];
+		const ShapeObjectValue *sval = dynamic_cast<const ShapeObjectValue *>(obj);
+		if (sval) return ObjectEntry(sval->getShape()->keyHandle(index), sval->borrowAtIndex(index));
+		ItemRef item(obj, index);
+		return ObjectEntry(KeyTable::intern(item.getMemberName()).getHandle(), item->unproxy());
+	}
+
+	std::size_t ObjectEntry::sort(ObjectEntry *entries, std::size_t count) {
+		std::stable_sort(entries, entries+count,[](const ObjectEntry &left, const ObjectEntry &right) {
+			return left.getKey().compare(right.getKey()) < 0;
+		});
+		std::size_t w = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			if (i+1 < count && (entries[i].key == entries[i+1].key || entries[i].getKey() == entries[i+1].getKey())) continue;
+			if (w != i) entries[w] = std::move(entries[i]);
+			w++;
+		}
+		return w;
+	}
+
+	PValue ObjectEntry::toItem() const {
+		return new ObjectProxyString(String(Value(key)), value);
+	}
+
+
+	ObjectValue::~ObjectValue() {
+		delete index.load(std::memory_order_relaxed);
+	}
+
+	std::size_t ObjectValue::memorySize() const {
+		std::size_t sz = sizeof(ObjectValue) + capacity * sizeof(ObjectEntry);
+		const ObjectIndex *idx = index.load(std::memory_order_acquire);
+		if (idx) sz += sizeof(ObjectIndex) + idx->memorySize();
+		return sz + proxies.memorySize();
+	}
+
+	void ObjectValue::resetIndex() {
+		delete index.exchange(nullptr, std::memory_order_relaxed);
+		proxies.clear();
+	}
+
+	void ObjectValue::buildIndex() const {
+		if (index.load(std::memory_order_acquire) != nullptr || curSize > 0xFFFFFFFEU) return;
+		ObjectIndex *idx = new ObjectIndex;
+		idx->build(curSize, [&](std::size_t i) {return items[i].getKey();}, curSize >= hashThreshold);
+		ObjectIndex *expected = nullptr;
+		//other thread could build the index in the meantime
+		if (!index.compare_exchange_strong(expected, idx, std::memory_order_acq_rel)) delete idx;
+	}
 
+	const ObjectEntry *ObjectValue::findIndexed(const ObjectIndex *idx, const std::string_view &name) const {
+		std::size_t i = idx->find(name);
+		return i < idx->count?items+i:nullptr;
+	}
 
 	std::size_t ObjectValue::size() const
 	{
@@ -13,22 +84,62 @@ namespace json {
 
 	RefCntPtr<const IValue>  ObjectValue::itemAtIndex(std::size_t index) const
 	{
-		if (index < curSize) return (const IValue *)((*this)[index]);
+		if (index < curSize) return proxies.get(index, capacity, [&]{return items[index].toItem();});
 		return getUndefined();
 	}
 
 	RefCntPtr<const IValue>  ObjectValue::member(const std::string_view& name) const {
-		const IValue *r = findSorted(name);
+		const ObjectEntry *r = findEntry(name);
 		if (r == nullptr) return getUndefined();
-		else return r;
+		else return proxies.get(r - items, capacity, [&]{return r->toItem();});
 	}
-	const IValue *ObjectValue::findSorted(const std::string_view &name) const
+
+	const IValue *ObjectValue::borrowAtIndex(std::size_t index) const
 	{
+		if (index < curSize) return items[index].value;
+		return getUndefined();
+	}
+
+	const IValue *ObjectValue::borrowMember(const std::string_view& name) const {
+		const ObjectEntry *r = findEntry(name);
+		if (r == nullptr) return getUndefined();
+		else return r->value;
+	}
+
+	StringView ObjectValue::memberNameAtIndex(std::size_t index) const {
+		if (index < curSize) return items[index].getKey();
+		return StringView();
+	}
+
+	const IValue *ObjectValue::memberKeyAtIndex(std::size_t index) const {
+		if (index < curSize) return items[index].key;
+		return nullptr;
+	}
+
+	bool ObjectValue::forEachRef(const IEnumFn &fn) const {
+		for (const ObjectEntry &e: *this) {
+			if (!fn(e.key) || !fn(e.value)) return false;
+		}
+		return true;
+	}
+
+	const ObjectEntry *ObjectValue::findEntry(const std::string_view &name) const
+	{
+		if (curSize >= indexThreshold) {
+			const ObjectIndex *idx = index.load(std::memory_order_acquire);
+			if (idx == nullptr) {
+				buildIndex();
+				idx = index.load(std::memory_order_acquire);
+			}
+			//the index is not used, if the object has been extended after the index has been built
+			if (idx != nullptr && idx->count == curSize) return findIndexed(idx, name);
+		}
 		std::size_t l = 0;
 		std::size_t r = size();
 		while (l < r) {
 			std::size_t m = (l + r) / 2;
-			int c = name.compare(operator[](m)->getMemberName());
+			StringView k = items[m].getKey();
+			int c = name.compare(k);
 			if (c > 0) {
 				l = m + 1;
 			}
@@ -36,27 +147,23 @@ namespace json {
 				r = m;
 			}
 			else {
-				return operator[](m);
+				return items+m;
 			}
 		}
 		return nullptr;
 	}
 
+	const IValue *ObjectValue::findSorted(const std::string_view &name) const
+	{
+		const ObjectEntry *e = findEntry(name);
+		return e?static_cast<const IValue *>(e->value):nullptr;
+	}
+
 
 	void ObjectValue::sort() {
-		std::stable_sort(begin(),end(),[](const PValue &left, const PValue &right) {
-			return left->getMemberName().compare(right->getMemberName()) < 0;
-		});
-		std::size_t n=1,cnt = this->curSize;
-		auto iter = std::remove_if(begin(), end(),[&](const PValue &f){
-			bool b = n<cnt && f->getMemberName() == this->operator [](n)->getMemberName();
-			++n;
-			return b;
-		});
-		auto remain = std::distance(iter, end());
-		for (int i = 0; i < remain; i++) {
-			pop_back();
-		}
+		resetIndex();
+		std::size_t cnt = ObjectEntry::sort(items, curSize);
+		while (curSize > cnt) pop_back();
 	}
 
 	RefCntPtr<ObjectValue> ObjectValue::create(std::size_t capacity) {
@@ -71,10 +178,10 @@ namespace json {
 	}
 
 	ObjectValue& ObjectValue::operator =(const ObjectValue& other) {
-		Container<PValue>::operator =(other);
+		Container<ObjectEntry>::operator =(other);
 		isDiff = other.isDiff;
+		resetIndex();
 		return *this;
 	}
 
 }
-
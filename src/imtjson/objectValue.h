@@ -1,32 +1,90 @@
 #pragma once
 
 #include <vector>
+#include <atomic>
 #include "basicValues.h"
 #include "container.h"
+#include "proxyCache.h"
 
 namespace json {
 
 	class Object;
+	struct ObjectIndex;
+
+	///Member of the object
+	/** The object stores the keys along with the values, so the members don't need proxies */
+	struct ObjectEntry {
+		///Key of the member - it is always a string value
+		PValue key;
+		///Value of the member (never a proxy)
+		PValue value;
+
+		ObjectEntry() {}
+		ObjectEntry(const PValue &key, const PValue &value):key(key),value(value) {}
+
+		StringView getKey() const {return key->getString();}
+
+		///Creates entry from an item which carries the key (a proxy)
+		static ObjectEntry fromItem(const PValue &item);
+		///Creates entry from a member of any object (shares the key, if possible)
+		static ObjectEntry fromMember(const IValue *obj, std::size_t index);
+		///Creates an item which carries the key (a proxy)
+		PValue toItem() const;
+
+		///Sorts entries by the key and removes duplicated keys
+		/**
+		 * @param entries entries to sort
+		 * @param count count of entries
+		 * @return count of remaining entries. If there are duplicated keys, the last one is kept. Entries
+		 * beyond the returned count are left in moved-from state
+		 */
+		static std::size_t sort(ObjectEntry *entries, std::size_t count);
+	};
 
-	class ObjectValue : public AbstractObjectValue, public Container<PValue> {
+	class ObjectValue : public AbstractObjectValue, public Container<ObjectEntry> {
 	public:
 
-		using Container<PValue>::Container;
+		using Container<ObjectEntry>::Container;
+		~ObjectValue();
+
+		///Objects with this or more members are indexed on the first lookup
+		/** The index keeps the keys in side arrays, so the search doesn't need to
+		 * access the string values of the keys */
+		static const std::size_t indexThreshold = 8;
+		///Objects with this or more members are indexed by a hash table
+		static const std::size_t hashThreshold = 64;
 
 		virtual std::size_t size() const override;
 		virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const override;
 		virtual RefCntPtr<const IValue> member(const std::string_view &name) const override;
+		virtual const IValue *borrowAtIndex(std::size_t index) const override;
+		virtual const IValue *borrowMember(const std::string_view &name) const override;
+		virtual StringView memberNameAtIndex(std::size_t index) const override;
+		virtual const IValue *memberKeyAtIndex(std::size_t index) const override;
+		virtual bool forEachRef(const IEnumFn &fn) const override;
+		virtual std::size_t memorySize() const override;
 
 		virtual bool getBool() const override {return true;}
 
+		using Container<ObjectEntry>::push_back;
+		///Pushes an item which carries the key
+		bool push_back(const PValue &item) {return push_back(ObjectEntry::fromItem(item));}
+
 		void sort();
 		const IValue *findSorted(const std::string_view &name) const;
+		const ObjectEntry *findEntry(const std::string_view &name) const;
+		///Builds lookup index of the members
+		/** The index is built automatically for larger objects. The function allows
+		 * to build the index for any object in advance. The object must be sorted and it
+		 * should not be modified after the index is built
+		 */
+		void buildIndex() const;
 
 		static RefCntPtr<ObjectValue> create(std::size_t capacity);
 		RefCntPtr<ObjectValue> clone() const;
 
-		using Container<PValue>::operator new;
-		using Container<PValue>::operator delete;
+		using Container<ObjectEntry>::operator new;
+		using Container<ObjectEntry>::operator delete;
 
 		bool isDiff = false;
 
@@ -34,6 +92,14 @@ namespace json {
 
 		ObjectValue &operator=(const ObjectValue &other);
 
+	protected:
+		///Lookup index of the members, created on demand
+		mutable std::atomic<ObjectIndex *> index = nullptr;
+		///Members returned with the key
+		ProxyCache proxies;
+
+		const ObjectEntry *findIndexed(const ObjectIndex *idx, const std::string_view &name) const;
+		void resetIndex();
 	};
 
 
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <limits>
+#include <new>
+#include "packedArray.h"
+#include "allocator.h"
+#include "arena.h"
+#include "value.h"
+
+namespace json {
+
+	static_assert(sizeof(PackedArrayValue<double>) % alignof(double) == 0, "Numbers must be aligned");
+	static_assert(sizeof(PackedArrayValue<LongInt>) % alignof(LongInt) == 0, "Numbers must be aligned");
+
+	RefCntPtr<const IValue> AbstractPackedArray::itemAtIndex(std::size_t index) const {
+		if (index >= count) return getUndefined();
+		std::atomic<const IValue *> *c = items.load(std::memory_order_acquire);
+		if (c) {
+			const IValue *v = c[index].load(std::memory_order_acquire);
+			if (v) return v;
+		}
+		//frozen arrays cache their items, so they can be shared without the refcounting
+		if (isImmortal()) return borrowAtIndex(index);
+		//the item is not cached, it is released with the last reference
+		return createItem(index);
+	}
+
+	const IValue *AbstractPackedArray::borrowAtIndex(std::size_t index) const {
+		if (index >= count) return getUndefined();
+		std::atomic<const IValue *> *c = items.load(std::memory_order_acquire);
+		if (c) {
+			const IValue *v = c[index].load(std::memory_order_acquire);
+			if (v) return v;
+		}
+		PValue v;
+		{
+			//cached items live as long as the array, they should not hold the arena
+			ArenaSuspend noArena;
+			v = createItem(index);
+		}
+		//preallocated values (small numbers, empty string) don't need to be cached
+		if (v->isImmortal()) return v;
+		//the item can be accessed by any thread which can access the array
+		v->publish();
+		//items of the frozen array are frozen as well
+		if (isImmortal()) v->setImmortal();
+		if (c == nullptr) {
+			c = new std::atomic<const IValue *>[count]();
+			std::atomic<const IValue *> *expected = nullptr;
+			//other thread could allocate the cache in the meantime
+			if (!items.compare_exchange_strong(expected, c, std::memory_order_acq_rel)) {
+				delete [] c;
+				c = expected;
+			}
+		}
+		const IValue *expected = nullptr;
+		const IValue *p = v;
+		if (c[index].compare_exchange_strong(expected, p, std::memory_order_acq_rel)) {
+			p->addRef();
+			return p;
+		} else {
+			return expected;
+		}
+	}
+
+	bool AbstractPackedArray::forEachRef(const IEnumFn &fn) const {
+		std::atomic<const IValue *> *c = items.load(std::memory_order_acquire);
+		if (c) {
+			for (std::size_t i = 0; i < count; i++) {
+				const IValue *v = c[i].load(std::memory_order_relaxed);
+				if (v && !fn(v)) return false;
+			}
+		}
+		return true;
+	}
+
+	AbstractPackedArray::~AbstractPackedArray() {
+		std::atomic<const IValue *> *c = items.load(std::memory_order_relaxed);
+		if (c) {
+			for (std::size_t i = 0; i < count; i++) {
+				const IValue *v = c[i].load(std::memory_order_relaxed);
+				if (v && v->release()) delete v;
+			}
+			delete [] c;
+		}
+	}
+
+	template<typename T>
+	PValue PackedArrayValue<T>::createItem(std::size_t index) const {
+		return Value(data()[index]).getHandle();
+	}
+
+	template<typename T>
+	bool PackedArrayValue<T>::equal(const IValue *other) const {
+		if (other->type() != array || other->size() != count || hashDiffers(this, other)) return false;
+		const PackedArrayValue *o = cast(other);
+		if (o) return std::equal(data(), data()+count, o->data());
+		for (std::size_t i = 0; i < count; i++) {
+			ItemRef b(other, i);
+			if (b->type() != number) return false;
+			NumberValueT<T, itemFlags> a(data()[i]);
+			if (!a.equal(b)) return false;
+		}
+		return true;
+	}
+
+	template<typename T>
+	std::size_t PackedArrayValue<T>::calcHash() const {
+		std::size_t h = hashSeed(array);
+		for (std::size_t i = 0; i < count; i++) h = hashCombine(h, hashNumber(static_cast<double>(data()[i])));
+		return hashFinish(h);
+	}
+
+	template<typename T>
+	const PackedArrayValue<T> *PackedArrayValue<T>::cast(const IValue *v) {
+		if ((v->flags() & packedNumbers) == 0) return nullptr;
+		return dynamic_cast<const PackedArrayValue *>(v->unproxy());
+	}
+
+	template<typename T>
+	RefCntPtr<PackedArrayValue<T> > PackedArrayValue<T>::create(std::size_t count) {
+		return new(count) PackedArrayValue(count);
+	}
+
+	template<typename T>
+	void *PackedArrayValue<T>::operator new(std::size_t sz, const std::size_t &count) {
+		return Allocator::getInstance()->alloc(sz + count * sizeof(T));
+	}
+
+	template<typename T>
+	void PackedArrayValue<T>::operator delete(void *ptr, const std::size_t &) {
+		Allocator::getInstance()->dealloc(ptr);
+	}
+
+	template<typename T>
+	void PackedArrayValue<T>::operator delete(void *ptr, std::size_t) {
+		Allocator::getInstance()->dealloc(ptr);
+	}
+
+	template class PackedArrayValue<LongInt>;
+	template class PackedArrayValue<ULongInt>;
+	template class PackedArrayValue<double>;
+
+	PValue PackedStringArrayValue::createItem(std::size_t index) const {
+		return Value(stringAt(index)).getHandle();
+	}
+
+	bool PackedStringArrayValue::equal(const IValue *other) const {
+		if (other->type() != array || other->size() != count || hashDiffers(this, other)) return false;
+		PackedStringsView strs = getStrings();
+		const PackedStringArrayValue *o = cast(other);
+		if (o) {
+			PackedStringsView ostrs = o->getStrings();
+			for (std::size_t i = 0; i < count; i++) {
+				if (strs[i] != ostrs[i]) return false;
+			}
+		} else {
+			for (std::size_t i = 0; i < count; i++) {
+				ItemRef b(other, i);
+				if (b->type() != string || (b->flags() & binaryString) || b->getString() != strs[i]) return false;
+			}
+		}
+		return true;
+	}
+
+	std::size_t PackedStringArrayValue::calcHash() const {
+		PackedStringsView strs = getStrings();
+		std::size_t h = hashSeed(array);
+		for (std::size_t i = 0; i < count; i++) h = hashCombine(h, hashString(strs[i]));
+		return hashFinish(h);
+	}
+
+	const PackedStringArrayValue *PackedStringArrayValue::cast(const IValue *v) {
+		if ((v->flags() & packedStrings) == 0) return nullptr;
+		return dynamic_cast<const PackedStringArrayValue *>(v->unproxy());
+	}
+
+	void *PackedStringArrayValue::operator new(std::size_t sz, const std::size_t &count, const std::size_t &bytes) {
+		return Allocator::getInstance()->alloc(sz + (count + 1) * sizeof(std::uint32_t) + bytes);
+	}
+
+	void PackedStringArrayValue::operator delete(void *ptr, const std::size_t &, const std::size_t &) {
+		Allocator::getInstance()->dealloc(ptr);
+	}
+
+	void PackedStringArrayValue::operator delete(void *ptr, std::size_t) {
+		Allocator::getInstance()->dealloc(ptr);
+	}
+
+	template<typename T, typename Get>
+	static PValue fillNumbers(const Get &get, std::size_t count) {
+		auto res = PackedArrayValue<T>::create(count);
+		T *d = res->data();
+		for (std::size_t i = 0; i < count; i++) {
+			const IValue *v = get(i);
+			if constexpr(std::is_same<T, double>::value) d[i] = v->getNumber();
+			else if constexpr(std::is_same<T, LongInt>::value) d[i] = v->getIntLong();
+			else d[i] = v->getUIntLong();
+		}
+		return PValue::staticCast(res);
+	}
+
+	template<typename Get>
+	static PValue packNumbers(const Get &get, std::size_t cnt) {
+		bool allUnsigned = true;
+		bool fitsSigned = true;
+		//integers and floating point numbers are not mixed, the items would lose their types
+		bool isFloat = (get(0)->flags() & (numberInteger|numberUnsignedInteger)) == 0;
+		for (std::size_t i = 0; i < cnt; i++) {
+			const IValue *v = get(i);
+			if (v->type() != number) return nullptr;
+			ValueTypeFlags f = v->flags();
+			//precise numbers, members with keys and user defined numbers are kept as they are
+			if (f & ~(numberInteger|numberUnsignedInteger|longInt)) return nullptr;
+			if (((f & (numberInteger|numberUnsignedInteger)) == 0) != isFloat) return nullptr;
+			if (f & numberUnsignedInteger) {
+				if (v->getUIntLong() > ULongInt(std::numeric_limits<LongInt>::max())) fitsSigned = false;
+			} else {
+				allUnsigned = false;
+			}
+		}
+		if (isFloat) return fillNumbers<double>(get, cnt);
+		if (allUnsigned) return fillNumbers<ULongInt>(get, cnt);
+		return fitsSigned?fillNumbers<LongInt>(get, cnt):nullptr;
+	}
+
+	template<typename Get>
+	static PValue packStrings(const Get &get, std::size_t cnt) {
+		for (std::size_t i = 0; i < cnt; i++) {
+			const IValue *v = get(i);
+			//binary strings, members with keys and user defined strings are kept as they are
+			if (v->type() != string || (v->flags() & ~plainString) != 0
+					|| v->getString().size() > PackedStringArrayValue::maxStringLength) return nullptr;
+		}
+		return PValue::staticCast(PackedStringArrayValue::create(cnt, [&](std::size_t i){return get(i)->getString();}));
+	}
+
+	template<typename Get>
+	static PValue packItems(const Get &get, std::size_t cnt) {
+		if (cnt < PackedArray::minPackSize) return nullptr;
+		switch (get(0)->type()) {
+			case number: return packNumbers(get, cnt);
+			case string: return packStrings(get, cnt);
+			default: return nullptr;
+		}
+	}
+
+	PValue PackedArray::pack(const IValue *arr) {
+		std::size_t cnt = arr->size();
+		if (cnt == 0 || arr->borrowAtIndex(0) == nullptr) return nullptr;
+		return packItems([arr](std::size_t i){return arr->borrowAtIndex(i);}, cnt);
+	}
+
+	PValue PackedArray::pack(const Value *items, std::size_t count) {
+		return packItems([items](std::size_t i)->const IValue *{return items[i].getHandle();}, count);
+	}
+
+	template<typename T>
+	Value Value::packedArray(const T *data, std::size_t count) {
+		if constexpr(std::is_arithmetic<T>::value) {
+			auto res = PackedArrayValue<PackedType<T> >::create(count);
+			std::copy(data, data+count, res->data());
+			return PValue::staticCast(res);
+		} else {
+			auto res = PackedStringArrayValue::create(count, [data](std::size_t i){return std::string_view(data[i]);});
+			if (res == nullptr) return Value(array, data, data+count);
+			return PValue::staticCast(res);
+		}
+	}
+
+	ValueTypeFlags Value::getPackedItemFlags() const {
+		if ((v->flags() & (packedNumbers|packedStrings)) == 0) return 0;
+		const AbstractPackedArray *p = dynamic_cast<const AbstractPackedArray *>(v->unproxy());
+		return p?p->getItemFlags():0;
+	}
+
+	template<typename T>
+	Range<const T *> Value::getPacked() const {
+		const PackedArrayValue<T> *p = PackedArrayValue<T>::cast(v);
+		if (p) return Range<const T *>(p->data(), p->data()+p->size());
+		else return Range<const T *>(nullptr, nullptr);
+	}
+
+	template Value Value::packedArray<char>(const char *, std::size_t);
+	template Value Value::packedArray<signed char>(const signed char *, std::size_t);
+	template Value Value::packedArray<unsigned char>(const unsigned char *, std::size_t);
+	template Value Value::packedArray<wchar_t>(const wchar_t *, std::size_t);
+	template Value Value::packedArray<char16_t>(const char16_t *, std::size_t);
+	template Value Value::packedArray<char32_t>(const char32_t *, std::size_t);
+	template Value Value::packedArray<short>(const short *, std::size_t);
+	template Value Value::packedArray<unsigned short>(const unsigned short *, std::size_t);
+	template Value Value::packedArray<int>(const int *, std::size_t);
+	template Value Value::packedArray<unsigned int>(const unsigned int *, std::size_t);
+	template Value Value::packedArray<long>(const long *, std::size_t);
+	template Value Value::packedArray<unsigned long>(const unsigned long *, std::size_t);
+	template Value Value::packedArray<long long>(const long long *, std::size_t);
+	template Value Value::packedArray<unsigned long long>(const unsigned long long *, std::size_t);
+	template Value Value::packedArray<float>(const float *, std::size_t);
+	template Value Value::packedArray<double>(const double *, std::size_t);
+	template Value Value::packedArray<long double>(const long double *, std::size_t);
+
+	template Value Value::packedArray<std::string>(const std::string *, std::size_t);
+	template Value Value::packedArray<std::string_view>(const std::string_view *, std::size_t);
+
+	PackedStringsView Value::getPackedStrings() const {
+		const PackedStringArrayValue *p = PackedStringArrayValue::cast(v);
+		if (p) return p->getStrings();
+		else return PackedStringsView();
+	}
+
+	template Range<const LongInt *> Value::getPacked<LongInt>() const;
+	template Range<const ULongInt *> Value::getPacked<ULongInt>() const;
+	template Range<const double *> Value::getPacked<double>() const;
+
+}
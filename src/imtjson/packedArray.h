@@ -0,0 +1,255 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "basicValues.h"
+
+namespace json {
+
+	class Value;
+
+	///Common part of the packed arrays
+	/** Items are materialized on demand. Items created by borrowAtIndex() are cached for
+	 * the lifetime of the array
+	 */
+	class AbstractPackedArray : public AbstractArrayValue {
+	public:
+
+		virtual std::size_t size() const override {return count;}
+		virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const override;
+		virtual const IValue *borrowAtIndex(std::size_t index) const override;
+		virtual bool forEachRef(const IEnumFn &fn) const override;
+		virtual bool getBool() const override {return true;}
+		///Retrieves flags of the items
+		/** @see Value::getPackedItemFlags() */
+		virtual ValueTypeFlags getItemFlags() const = 0;
+
+		~AbstractPackedArray();
+
+	protected:
+		AbstractPackedArray(std::size_t count):count(count) {}
+
+		std::size_t count;
+		///Materialized items, allocated on the first borrowAtIndex()
+		mutable std::atomic<std::atomic<const IValue *> *> items = nullptr;
+
+		///Creates the item
+		virtual PValue createItem(std::size_t index) const = 0;
+		///Size of the cache of materialized items
+		std::size_t itemsCacheSize() const {
+			return items.load(std::memory_order_relaxed)?count * sizeof(std::atomic<const IValue *>):0;
+		}
+	};
+
+	///Array of numbers packed in a contiguous memory
+	/** The numbers are stored in one allocation along with the array, so the array
+	 * of N numbers occupies N*8 bytes instead of N values. Small integers are returned
+	 * as preallocated values, other items are materialized on demand.
+	 *
+	 * Supported types are LongInt, ULongInt and double. The numbers can be accessed
+	 * directly through the function Value::getPacked()
+	 *
+	 * The array is created by Value::packedArray(), by conversion of std::vector of numbers
+	 * and by the parsers for arrays which contain only numbers
+	 */
+	template<typename T>
+	class PackedArrayValue : public AbstractPackedArray {
+	public:
+
+		///Flags of the items
+		static const ValueTypeFlags itemFlags = std::is_floating_point<T>::value?0
+				:(std::is_signed<T>::value?numberInteger:numberUnsignedInteger)
+				 |(sizeof(T) > sizeof(Int)?longInt:0);
+
+		virtual ValueTypeFlags flags() const override {return packedNumbers;}
+		virtual ValueTypeFlags getItemFlags() const override {return itemFlags;}
+		virtual std::size_t memorySize() const override {
+			return sizeof(PackedArrayValue) + count * sizeof(T) + itemsCacheSize();
+		}
+		virtual bool equal(const IValue *other) const override;
+
+		///Creates the array
+		/**
+		 * @param count count of numbers
+		 * @return array with uninitialized numbers. Fill the numbers through the function data()
+		 */
+		static RefCntPtr<PackedArrayValue> create(std::size_t count);
+
+		///Retrieves the numbers
+		T *data() {return reinterpret_cast<T *>(this+1);}
+		///Retrieves the numbers
+		const T *data() const {return reinterpret_cast<const T *>(this+1);}
+
+		///Retrieves packed array from the value
+		/**
+		 * @param v value
+		 * @return pointer to the packed array, or nullptr, if the value is not packed array of this type
+		 */
+		static const PackedArrayValue *cast(const IValue *v);
+
+		void *operator new(std::size_t sz, const std::size_t &count);
+		void operator delete(void *ptr, const std::size_t &count);
+		void operator delete(void *ptr, std::size_t sz);
+
+	protected:
+		PackedArrayValue(std::size_t count):AbstractPackedArray(count) {}
+
+		virtual PValue createItem(std::size_t index) const override;
+		virtual std::size_t calcHash() const override;
+	};
+
+	///Lightweight view to the strings of a packed string array
+	class PackedStringsView {
+	public:
+		PackedStringsView():offsets(nullptr),chars(nullptr),count(0) {}
+		PackedStringsView(const std::uint32_t *offsets, const char *chars, std::size_t count)
+			:offsets(offsets),chars(chars),count(count) {}
+
+		std::size_t size() const {return count;}
+		bool empty() const {return count == 0;}
+		StringView operator[](std::size_t index) const {
+			return StringView(chars+offsets[index], offsets[index+1]-offsets[index]);
+		}
+
+		class iterator {
+		public:
+			const PackedStringsView *owner;
+			std::size_t index;
+
+			iterator(const PackedStringsView *owner, std::size_t index):owner(owner),index(index) {}
+			StringView operator *() const {return (*owner)[index];}
+			iterator &operator++() {++index;return *this;}
+			iterator operator++(int) {++index;return iterator(owner, index-1);}
+			bool operator==(const iterator &other) const {return index == other.index;}
+			bool operator!=(const iterator &other) const {return index != other.index;}
+		};
+
+		iterator begin() const {return iterator(this, 0);}
+		iterator end() const {return iterator(this, count);}
+
+	protected:
+		const std::uint32_t *offsets;
+		const char *chars;
+		std::size_t count;
+	};
+
+	///Array of strings packed in a single buffer
+	/** The characters of all strings are stored in one allocation along with the array and
+	 * a table of offsets. Items are materialized on demand. The strings can
+	 * be accessed directly through the function Value::getPackedStrings()
+	 *
+	 * The array is created by Value::packedArray(), by conversion of std::vector of strings
+	 * and by the parsers for arrays which contain only short strings
+	 */
+	class PackedStringArrayValue : public AbstractPackedArray {
+	public:
+
+		///Longest string packed by the parsers
+		static const std::size_t maxStringLength = 64;
+
+		virtual ValueTypeFlags flags() const override {return packedStrings | plain;}
+		virtual ValueTypeFlags getItemFlags() const override {return plain;}
+		virtual std::size_t memorySize() const override {
+			return sizeof(PackedStringArrayValue) + (count + 1) * sizeof(std::uint32_t)
+					+ offsets()[count] + itemsCacheSize();
+		}
+		virtual bool equal(const IValue *other) const override;
+
+		///Creates the array
+		/**
+		 * @param count count of strings
+		 * @param get function which returns string at given index
+		 * @return packed array, or nullptr, if the strings are too large to be packed
+		 */
+		template<typename Get>
+		static RefCntPtr<PackedStringArrayValue> create(std::size_t count, const Get &get);
+
+		///Retrieves the strings
+		PackedStringsView getStrings() const {return PackedStringsView(offsets(), chars(), count);}
+		///Retrieves string at index
+		StringView stringAt(std::size_t index) const {return getStrings()[index];}
+
+		///Retrieves packed array from the value
+		/**
+		 * @param v value
+		 * @return pointer to the packed array, or nullptr, if the value is not packed array of strings
+		 */
+		static const PackedStringArrayValue *cast(const IValue *v);
+
+		void *operator new(std::size_t sz, const std::size_t &count, const std::size_t &bytes);
+		void operator delete(void *ptr, const std::size_t &count, const std::size_t &bytes);
+		void operator delete(void *ptr, std::size_t sz);
+
+	protected:
+		PackedStringArrayValue(std::size_t count):AbstractPackedArray(count) {}
+
+		///plainString, if all strings are plain
+		ValueTypeFlags plain = 0;
+
+		virtual PValue createItem(std::size_t index) const override;
+		virtual std::size_t calcHash() const override;
+
+		///Offsets of the strings (count+1) are stored after the object
+		std::uint32_t *offsets() const {
+			return reinterpret_cast<std::uint32_t *>(const_cast<PackedStringArrayValue *>(this)+1);
+		}
+		///Characters are stored after the offsets
+		char *chars() const {
+			return reinterpret_cast<char *>(offsets()+count+1);
+		}
+	};
+
+	template<typename Get>
+	RefCntPtr<PackedStringArrayValue> PackedStringArrayValue::create(std::size_t count, const Get &get) {
+		std::size_t bytes = 0;
+		for (std::size_t i = 0; i < count; i++) bytes += std::string_view(get(i)).size();
+		if (bytes > std::numeric_limits<std::uint32_t>::max()) return nullptr;
+		RefCntPtr<PackedStringArrayValue> res = new(count, bytes) PackedStringArrayValue(count);
+		std::uint32_t *ofs = res->offsets();
+		char *c = res->chars();
+		std::uint32_t pos = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			std::string_view str(get(i));
+			ofs[i] = pos;
+			std::copy(str.begin(), str.end(), c+pos);
+			pos += static_cast<std::uint32_t>(str.size());
+		}
+		ofs[count] = pos;
+		res->plain = AbstractStringValue::checkPlain(std::string_view(c, pos));
+		return res;
+	}
+
+	///Storage type used to pack numbers of type T
+	template<typename T>
+	using PackedType = std::conditional_t<std::is_floating_point<T>::value, double,
+			std::conditional_t<std::is_signed<T>::value, LongInt, ULongInt> >;
+
+	///Packs arrays created by the parsers
+	class PackedArray {
+	public:
+		///Minimum count of items to be packed
+		static const std::size_t minPackSize = 16;
+
+		///Packs an array
+		/**
+		 * @param arr array
+		 * @return packed array, or nullptr, if the array cannot be packed. Only arrays
+		 * which contain at least minPackSize plain numbers or plain strings up to
+		 * PackedStringArrayValue::maxStringLength bytes are packed. Arrays which mix integers with
+		 * floating point numbers are not packed, so the items keep their types. Arrays which
+		 * don't keep their items (see IValue::borrowAtIndex()) are not packed too
+		 */
+		static PValue pack(const IValue *arr);
+		///Packs items of an array
+		/**
+		 * @param items items of the array
+		 * @param count count of items
+		 * @return packed array, or nullptr, if the items cannot be packed
+		 */
+		static PValue pack(const Value *items, std::size_t count);
+	};
+
+}
@@ -6,6 +6,21 @@
 #include "object.h"
 #include "array.h"
 #include "utf8.h"
+#include "arena.h"
+#include "objectValue.h"
+#include "string.h"
+#include "keyTable.h"
+#include "shapeValue.h"
+#include "smallObjectValue.h"
+#include "packedArray.h"
+#include "stringValue.h"
+#include "sharedBuffer.h"
+#include "dedup.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
 
 namespace json {
 
@@ -16,6 +31,37 @@ namespace json {
 	 */
 	extern bool enableParsePreciseNumbers;
 
+	///enables sharing of keys between parsed objects with the same structure
+	/** this option is global for whole application. If you need specify
+	 * option locally, construct Parse instance with correct flag
+	 *
+	 * @see Shape
+	 */
+	extern bool enableParseShapes;
+
+	///enables packing of arrays which contain only numbers or only short strings
+	/** this option is global for whole application. If you need specify
+	 * option locally, construct Parse instance with correct flag. Default is false
+	 *
+	 * @see PackedArrayValue, PackedStringArrayValue
+	 */
+	extern bool enableParsePackedArrays;
+
+
+	///Detects sources which read a contiguous buffer
+	/** Such source has the function getRemain(), which returns unread part of the buffer as
+	 * a string view, and the function skip(), which moves the read position. The parser reads
+	 * such sources directly through a pointer and it scans whitespaces and strings in bulk
+	 *
+	 * @see StreamFromString, SharedBufferSource
+	 */
+	template<typename T, typename = void>
+	struct IsContiguousSource: std::false_type {};
+	template<typename T>
+	struct IsContiguousSource<T, std::void_t<
+			decltype(std::string_view(std::declval<T &>().getRemain())),
+			decltype(std::declval<T &>().skip(std::size_t()))> >: std::true_type {};
+
 
 	template<typename Fn>
 	class Parser {
@@ -38,9 +84,53 @@ namespace json {
 		 *
 		 */
 		static const Flags allowPreciseNumbers = 2;
+		///Allocate parsed values in an arena
+		/** The parser creates new Arena and allocates all parsed values in it. The
+		 * whole document is released at once when the last value of the document is released.
+		 * Note that arena is active for the current thread until the parser is destroyed
+		 *
+		 * @see Arena
+		 */
+		static const Flags useArena = 4;
+		///Objects with the same keys share the keys
+		/** Objects which have more members than SmallObjectValue::maxMembers are created with
+		 * a shape (see Shape). Keys of the objects are stored once for all objects
+		 * with the same keys. The values are stored in the objects. The parser remembers
+		 * the order of the keys of the known shapes, so it doesn't need to sort the objects of
+		 * the same shape.
+		 */
+		static const Flags useShapes = 8;
+		///Arrays which contain only numbers or only short strings are packed
+		/** Numbers of the arrays with PackedArray::minPackSize or more numbers are stored
+		 * in a contiguous memory (see PackedArrayValue). Strings of such arrays are stored
+		 * in a single buffer (see PackedStringArrayValue). Items are materialized on demand.
+		 * Precise numbers and arrays which mix integers with floating point numbers are not packed
+		 */
+		static const Flags packArrays = 16;
+		///Equal subtrees are shared
+		/** The parser keeps a table of parsed values (see DedupTable). Every parsed
+		 * string, number, array or object which is equal to an already parsed value
+		 * is replaced by that value. This reduces memory occupied by documents with repeating
+		 * content, but the parsing is slower
+		 *
+		 * @see Value::dedup
+		 */
+		static const Flags dedupValues = 32;
 
 
-		Parser(Fn &&source, Flags flags = 0) :rd(std::forward<Fn>(source)),flags(flags) {}
+		Parser(Fn &&source, Flags flags = 0)
+			:rd(std::forward<Fn>(source)),flags(flags)
+			,arenaScope((flags & useArena)?Arena::create():PArena()) {}
+		///Construct parser which allocates values in given arena
+		/**
+		 * @param source source function
+		 * @param flags parser flags
+		 * @param arena arena used to allocate parsed values. If the arena is nullptr, standard allocator is used
+		 * (unless useArena flag is set)
+		 */
+		Parser(Fn &&source, Flags flags, const PArena &arena)
+			:rd(std::forward<Fn>(source)),flags(flags)
+			,arenaScope(arena == nullptr && (flags & useArena)?Arena::create():arena) {}
 
 		virtual Value parse();
 		Value parseObject();
@@ -65,6 +155,30 @@ namespace json {
 
 		StrIdx readString();
 		void freeString(const StrIdx &str);
+		///Creates string which refers to the source buffer
+		/** @return the string, or undefined, if the string must be copied */
+		Value createStringRef();
+		///Creates the key, the keys are interned
+		String createKey(const std::string_view &str);
+		///Creates object from the members collected in tmpObj
+		/**
+		 * @param tmpObjPos index of the first member in tmpObj. Members are removed from tmpObj
+		 * @param c last character, it is reported when the keys are duplicated
+		 * @return the object
+		 */
+		Value createObject(std::size_t tmpObjPos, int c);
+		///Creates array from the items collected in tmpArr
+		/**
+		 * @param tmpArrPos index of the first item in tmpArr. Items are removed from tmpArr
+		 * @return the array
+		 */
+		Value createArray(std::size_t tmpArrPos);
+		///Creates object with a shape from the entries (in order of parsing)
+		/** @return the object, or undefined, if the object cannot have a shape */
+		Value createShapeObject(ObjectEntry *entries, std::size_t count);
+
+		///True, if the source reads a contiguous buffer
+		static constexpr bool contiguous = IsContiguousSource<std::remove_reference_t<Fn> >::value;
 
 		class Reader {
 			///source iterator
@@ -85,10 +199,17 @@ namespace json {
 			  */
 			    
 			bool loaded;
+			///Read position, when the source is contiguous. The position of the source is updated by the destructor
+			const char *pos = nullptr;
+			///End of the buffer, when the source is contiguous
+			const char *end = nullptr;
+			///Start of the buffer, when the source is contiguous
+			const char *begin = nullptr;
 
 
 		public:
 			int next() {
+				if constexpr(contiguous) return pos < end?static_cast<unsigned char>(*pos):-1;
 				//if char is not loaded, load it now
 				if (!loaded) {
 					//load
@@ -101,17 +222,26 @@ namespace json {
 			}
 
 			int nextWs() {
+				if constexpr(contiguous) {
+					while (pos < end && isspace(static_cast<unsigned char>(*pos))) ++pos;
+					return next();
+				}
 				char n = next();
 				while (isspace(n)) { commit(); n = next(); }
 				return n;
 			}
 
 			void commit() {
+				if constexpr(contiguous) {
+					if (pos < end) ++pos;
+					return;
+				}
 				//just mark character not loaded, which causes, that next() will load next character
 				loaded = false;
 			}
 
 			int nextCommit() {
+				if constexpr(contiguous) return readFast();
 				if (loaded) {
 					loaded = false;
 					return c;
@@ -121,6 +251,11 @@ namespace json {
 			}
 
 			void putBack(int c) {
+				if constexpr(contiguous) {
+					//the character is still in the buffer
+					if (c != -1) --pos;
+					return;
+				}
 				loaded = true;
 				this->c = c;
 			}
@@ -132,55 +267,49 @@ namespace json {
 			 */
 
 			int readFast() {
+				if constexpr(contiguous) return pos < end?static_cast<unsigned char>(*pos++):-1;
 				return source();
 			}
 
-			Reader(Fn &&fn) :source(std::forward<Fn>(fn)), loaded(false) {}
+			Reader(Fn &&fn) :source(std::forward<Fn>(fn)), loaded(false) {
+				if constexpr(contiguous) {
+					std::string_view data(source.getRemain());
+					begin = pos = data.data();
+					end = pos + data.size();
+				}
+			}
+			~Reader() {
+				if constexpr(contiguous) source.skip(pos - begin);
+			}
+			Reader(const Reader &) = delete;
+			Reader &operator=(const Reader &) = delete;
+
+			///Direct access to the source, the current character must be commited
+			/** @note position of the contiguous source is updated when the reader is destroyed */
+			std::remove_reference_t<Fn> &getSource() {return source;}
+			bool isLoaded() const {return loaded;}
+
+			///Retrieves unread part of the contiguous buffer
+			std::string_view getRemain() const {return std::string_view(pos, end - pos);}
+			///Retrieves read position in the contiguous buffer
+			const char *getPos() const {return pos;}
+			///Moves read position in the contiguous buffer
+			void setPos(const char *p) {pos = p;}
+			///Skips characters of the contiguous buffer
+			void skip(std::size_t count) {pos += count;}
 
 		};
 
 		Reader rd;
 
-		///parses unsigned from the stream
-		/**
-		@param res there will be stored result
-		@param counter there will be stored count of digits has been read
-		@retval true number is complete, no more digits in the stream
-		@retval false number is not complete, parser stopped on integer overflow
-		*/	    
-		bool parseUnsigned(UInt &res, int &counter);
-		///parses integer and stores result to the double
-		/** By storing result into double causes, that final number will rounded
-		  @param intPart already parsed pard by parseUnsigned
-		  @return parsed number as double
-		  @note function stops on first non-digit character (including dot)
-		*/
-		double parseLargeUnsigned(UInt intPart);
-		///Parses decimal part
-		/**
-			works similar as parseLargeUnsigned, but result is number between 0 and 1
-			(mantisa). Function stops on first non-digit character (including dot, so
-			dot must be already extacted)
-
-			@return parsed mantisa
-		*/
-		double parseDecimalPart();
-		///Parse number and store it as floating point number
-		/**
-		 @param intpart part parsed by parseUnsigned. It can be however 0 to start
-		 from the beginning
-		 @param neg true if '-' sign has been extracted.
-		 @return parsed value
-		 @note function doesn't extract leading sign '+' or '-' it expects that
-		 caller already used readSign() function
-		*/
-		Value parseDouble(UInt intpart, bool neg);
-		///Reads sign '+' or '-' from the stream
+		///Reads text of the number
 		/**
-		@retval true there were sign '-'.
-		@retval false there were sign '+' or nothing
-		*/
-		bool readSign();
+		 * @param isFloat set to true, if the number has a decimal part or an exponent
+		 * @param tmp temporary string which contains the text, if the source is not contiguous. It must
+		 * be released by freeString()
+		 * @return text of the number
+		 */
+		std::string_view readNumber(bool &isFloat, StrIdx &tmp);
 
 		///Parses unicode sequence encoded as \uXXXX, stores it as UTF-8 into the tmpstr
 		void parseUnicode();
@@ -196,14 +325,92 @@ namespace json {
 		///Temporary array - to keep allocated memory
 		std::vector<Value> tmpArr;
 
+		///Temporary members of objects - to keep allocated memory
+		std::vector<ObjectEntry> tmpObj;
+
+		///Maximum count of keys cached by the parser
+		static const std::size_t maxCachedKeys = 4096;
+		///Interned keys already parsed, avoids locking of the KeyTable (the view refers to the content of the string)
+		std::unordered_map<std::string_view, String> keyCache;
+
+		///Known order of keys of the shape
+		struct ShapeOrder {
+			///Keys in order of parsing
+			std::vector<const IValue *> keys;
+			PShape shape;
+			///Index of the parsed entry for every key of the shape
+			std::vector<std::size_t> order;
+		};
+		///Maximum count of shapes cached by the parser
+		static const std::size_t maxCachedShapes = 256;
+		///Shapes already used, indexed by hash of keys in order of parsing
+		std::unordered_map<std::size_t, ShapeOrder> shapeCache;
+		///Temporary keys - to keep allocated memory
+		std::vector<PValue> tmpKeys;
+		///Canonical values, when dedupValues is set
+		DedupTable dedupTable;
+
+		Value dedup(const Value &v) {
+			if (flags & dedupValues) return Value(dedupTable.intern(v.getHandle()));
+			else return v;
+		}
+
 		Flags flags;
+
+		///Keeps the arena active while the parser exists
+		ArenaScope arenaScope;
 	};
 
 
 	class ParserHelper {
 		template<typename Fn>
 		friend class Parser;
+		friend class IndexedParser;
+		template<typename T> friend struct NumbParser;
 		static Value numberFromStringRaw(std::string_view str, bool force_double);
+		///Creates number from its text
+		/**
+		 * @param str valid text of the number
+		 * @param isFloat true, if the number has a decimal part or an exponent. Integers which
+		 * don't fit to UInt are also converted to double
+		 * @return number
+		 */
+		static Value numberFromText(std::string_view str, bool isFloat);
+		///Converts text to the nearest double (correctly rounded)
+		static double parseDouble(std::string_view str);
+		///Parses digits as unsigned integer, 8 digits are converted at once
+		/**
+		 * @param str digits
+		 * @param res result
+		 * @retval true success
+		 * @retval false the number doesn't fit to the UInt
+		 */
+		static bool parseUnsigned(std::string_view str, UInt &res);
+
+		///Counts leading characters which are copied without a conversion
+		/** @return count of leading ASCII characters which are neither quotes nor backslashes */
+		static std::size_t scanPlain(const std::string_view &str) {
+			const char *beg = str.data();
+			const char *p = beg;
+			const char *end = beg + str.size();
+			//test 8 characters at once
+			const std::uint64_t ones = 0x0101010101010101ULL;
+			const std::uint64_t highs = 0x8080808080808080ULL;
+			while (end - p >= 8) {
+				std::uint64_t w;
+				std::memcpy(&w, p, 8);
+				std::uint64_t q = w ^ (ones * '"');
+				std::uint64_t b = w ^ (ones * '\\');
+				if ((((q - ones) & ~q) | ((b - ones) & ~b) | w) & highs) break;
+				p += 8;
+			}
+			while (p < end) {
+				unsigned char c = *p;
+				if (c == '"' || c == '\\' || c >= 0x80) break;
+				++p;
+			}
+			return p - beg;
+		}
 	};
 
 	class ParseError:public std::exception {
@@ -257,7 +464,9 @@ namespace json {
 	template<typename Fn>
 	inline Value Value::parse(Fn && source)
 	{
-		Parser<Fn> parser(std::forward<Fn>(source), enableParsePreciseNumbers?Parser<Fn>::allowPreciseNumbers:0);
+		Parser<Fn> parser(std::forward<Fn>(source), (enableParsePreciseNumbers?Parser<Fn>::allowPreciseNumbers:0)
+				| (enableParseShapes?Parser<Fn>::useShapes:0)
+				| (enableParsePackedArrays?Parser<Fn>::packArrays:0));
 		return parser.parse();
 	}
 
@@ -266,15 +475,15 @@ namespace json {
 	{
 		int c = rd.nextWs();
 		switch (c) {
-			case '{': rd.commit(); return parseObject();
-			case '[': rd.commit(); return parseArray();
-			case '"': rd.commit(); return parseString();
+			case '{': rd.commit(); return dedup(parseObject());
+			case '[': rd.commit(); return dedup(parseArray());
+			case '"': rd.commit(); return dedup(parseString());
 			case 't': return parseTrue();
 			case 'f': return parseFalse();
 			case 'n': return parseNull();
 			case -1: throw ParseError("Unexpected end of stream",c);
 			default: if (isdigit(c) || c == '+' || c == '-' || c == '.')
-							return parseNumber();
+							return dedup(parseNumber());
 						else
 							throw ParseError("Unexpected data",c);
 
@@ -284,7 +493,7 @@ namespace json {
 	template<typename Fn>
 	inline Value Parser<Fn>::parseObject()
 	{
-		std::size_t tmpArrPos = tmpArr.size();
+		std::size_t tmpObjPos = tmpObj.size();
 		int c = rd.nextWs();
 		if (c == '}') {
 			rd.commit();
@@ -296,8 +505,11 @@ namespace json {
 			if (c != '"') 
 				throw ParseError("Expected a key (string)", c);
 			rd.commit();
+			String key;
 			try {
 				name = readString();
+				key = createKey(getString(name));
+				freeString(name);
 			}
 			catch (ParseError &e) {
 				e.addContext(getString(name));
@@ -309,12 +521,10 @@ namespace json {
 					throw ParseError("Expected ':'", c);
 				rd.commit();
 				Value v = parse();
-				tmpArr.push_back(Value(getString(name),v));
-				freeString(name);
+				tmpObj.push_back(ObjectEntry(key.getHandle(), v.getHandle()->unproxy()));
 			}
 			catch (ParseError &e) {
-				e.addContext(getString(name));
-				freeString(name);
+				e.addContext(key.str());
 				throw;
 			}
 			c = rd.nextWs();
@@ -330,13 +540,42 @@ namespace json {
 				throw ParseError("Expected ',' or '}'", c);
 			}
 		} while (cont);		
-		auto len = tmpArr.size() - tmpArrPos;
-		Value res(object, tmpArr.begin()+tmpArrPos, tmpArr.end(), true);
-		if (((flags & allowDupKeys) == 0) && (res.size() != len)) {
+		return createObject(tmpObjPos, c);
+	}
+
+	template<typename Fn>
+	inline Value Parser<Fn>::createObject(std::size_t tmpObjPos, int c)
+	{
+		auto len = tmpObj.size() - tmpObjPos;
+		if (len <= SmallObjectValue::maxMembers) {
+			RefCntPtr<SmallObjectValue> sres = SmallObjectValue::create(len);
+			for (auto iter = tmpObj.begin()+tmpObjPos; iter != tmpObj.end(); ++iter) {
+				sres->push_back(std::move(*iter));
+			}
+			tmpObj.resize(tmpObjPos);
+			sres->sort();
+			if (((flags & allowDupKeys) == 0) && (sres->size() != len)) {
+				throw ParseError("Duplicated keys",c);
+			}
+			return PValue(sres);
+		}
+		if (flags & useShapes) {
+			Value sres = createShapeObject(tmpObj.data()+tmpObjPos, len);
+			if (sres.defined()) {
+				tmpObj.resize(tmpObjPos);
+				return sres;
+			}
+		}
+		RefCntPtr<ObjectValue> res = ObjectValue::create(len);
+		for (auto iter = tmpObj.begin()+tmpObjPos; iter != tmpObj.end(); ++iter) {
+			res->push_back(std::move(*iter));
+		}
+		tmpObj.resize(tmpObjPos);
+		res->sort();
+		if (((flags & allowDupKeys) == 0) && (res->size() != len)) {
 			throw ParseError("Duplicated keys",c);
 		}
-		tmpArr.resize(tmpArrPos);
-		return res;
+		return PValue(res);
 	}
 
 	template<typename Fn>
@@ -379,6 +618,19 @@ namespace json {
 				throw;
 			}
 		} while (cont);
+		return createArray(tmpArrPos);
+	}
+
+	template<typename Fn>
+	inline Value Parser<Fn>::createArray(std::size_t tmpArrPos)
+	{
+		if ((flags & packArrays) && tmpArr.size() - tmpArrPos >= PackedArray::minPackSize) {
+			PValue packed = PackedArray::pack(tmpArr.data()+tmpArrPos, tmpArr.size() - tmpArrPos);
+			if (packed != nullptr) {
+				tmpArr.resize(tmpArrPos);
+				return packed;
+			}
+		}
 		Value res(array, tmpArr.begin()+tmpArrPos, tmpArr.end(), true);
 		tmpArr.resize(tmpArrPos);
 		return res;
@@ -406,20 +658,6 @@ namespace json {
 		return Value(nullptr);
 	}
 
-	template<typename Fn>
-	inline bool Parser<Fn>::readSign() {
-		bool isneg = false;
-		char c = rd.next();
-		if (c == '-') {
-			isneg = true; rd.commit();
-		}
-		else if (c == '+') {
-			isneg = false; rd.commit();
-		}
-		return isneg;
-		
-	}
-
 	template<typename Fn>
 	inline void Parser<Fn>::parseUnicode()
 	{
@@ -455,48 +693,79 @@ namespace json {
 			freeString(numb);
 			return Value(v);
 		} else {
+			bool isFloat = false;
+			StrIdx tmp(0,0);
+			std::string_view text = readNumber(isFloat, tmp);
+			Value v = ParserHelper::numberFromText(text, isFloat);
+			if (tmp.second) freeString(tmp);
+			return v;
+		}
+
+	}
 
-			//first try to read number as signed or unsigned integer
-			UInt intpart;
-			//read sign and return true whether it is '-' (discard '+')
-			bool isneg = readSign();
-			//test next character
+	template<typename Fn>
+	inline std::string_view Parser<Fn>::readNumber(bool &isFloat, StrIdx &tmp)
+	{
+		std::size_t start = tmpstr.size();
+		const char *begin = nullptr;
+		if constexpr(contiguous) begin = rd.getPos();
+		auto accept = [&](int c) {
+			if constexpr(!contiguous) tmpstr.push_back(static_cast<char>(c));
+			rd.commit();
+		};
+		auto digits = [&] {
+			int c = rd.next();
+			while (isdigit(c)) {
+				accept(c);
+				c = rd.next();
+			}
+			return c;
+		};
+		try {
 			int c = rd.next();
+			if (c == '-' || c == '+') {
+				accept(c);
+				c = rd.next();
+			}
 			//it should be digit or dot (because .3 is valid number)
 			if (!isdigit(c) && c != '.')
 				throw ParseError("Expected '0'...'9', '.', '+' or '-'", c);
-			//declared dummy var (we don't need counter here)
-			int counter;
-			//parse sequence of numbers as unsigned integer
-			//function returns false, if overflow detected
-			bool complete = parseUnsigned(intpart,counter);
-			//in case of overflow or dot follows, continue to read as floating number
-			if (!complete || rd.next() == '.' || toupper(rd.next()) == 'E') {
-				//parse floating number (give it already parsed informations)
-				return parseDouble(intpart, isneg);
-			}
-			//is negative?
-			if (isneg) {
-				//tests, whether highest bit of unsigned integer is set
-				//if so, converting to signed triggers overflow
-				if (intpart & (UInt(1) << (sizeof(intpart) * 8 - 1))) {
-					//convert number to float
-					double v = (double)intpart;
-					//return negative value
-					return Value(-v);
-				}
-				else {
-					//convert to signed and return negative
-					return Value(-intptr_t(intpart));
-				}
+			//integer part longer than the largest double is rejected
+			std::size_t intDigits = 0;
+			while (isdigit(c)) {
+				if (++intDigits > std::numeric_limits<double>::max_exponent10 + 1)
+					throw ParseError("Too long number", c);
+				accept(c);
+				c = rd.next();
 			}
-			else {
-				//return unsigned version
-				return Value(intpart);
+			if (c == '.') {
+				isFloat = true;
+				accept(c);
+				c = rd.next();
+				if (!isdigit(c)) throw ParseError("Expected '0'...'9' after '.'", c);
+				c = digits();
 			}
-
+			if (c == 'e' || c == 'E') {
+				isFloat = true;
+				accept(c);
+				c = rd.next();
+				if (c == '-' || c == '+') {
+					accept(c);
+					c = rd.next();
+				}
+				if (!isdigit(c)) throw ParseError("Expected '0'...'9' after 'E'", c);
+				digits();
+			}
+		} catch (...) {
+			tmpstr.resize(start);
+			throw;
+		}
+		if constexpr(contiguous) {
+			return std::string_view(begin, rd.getPos() - begin);
+		} else {
+			tmp = StrIdx(start, tmpstr.size() - start);
+			return getString(tmp);
 		}
-
 	}
 
 	template<typename Fn>
@@ -508,12 +777,82 @@ namespace json {
 			else return Value(val);
 		};
 
+		if constexpr(std::is_same<std::decay_t<Fn>, SharedBufferSource>::value) {
+			Value ref = createStringRef();
+			if (ref.defined()) return ref;
+		}
 		StrIdx str = readString();
 		Value res (createValue(getString(str)));
 		freeString(str);
 		return res;
 	}
 
+	template<typename Fn>
+	inline Value Parser<Fn>::createStringRef()
+	{
+		std::string_view remain = rd.getRemain();
+		//only ascii strings without escape sequences are referred, others must be decoded
+		std::size_t len = ParserHelper::scanPlain(remain);
+		if (len < StringRefValue::minSize || len == remain.size() || remain[len] != '"') return Value();
+		rd.skip(len+1);
+		return new StringRefValue(rd.getSource().getBuffer(), remain.substr(0, len));
+	}
+
+	template<typename Fn>
+	inline String Parser<Fn>::createKey(const std::string_view &str)
+	{
+		if (str.size() > KeyTable::maxKeyLength) return String(str);
+		auto iter = keyCache.find(str);
+		if (iter != keyCache.end()) return iter->second;
+		String key = KeyTable::intern(str);
+		if (keyCache.size() < maxCachedKeys) keyCache.emplace(key.str(), key);
+		return key;
+	}
+
+	template<typename Fn>
+	inline Value Parser<Fn>::createShapeObject(ObjectEntry *entries, std::size_t count)
+	{
+		if (count > Shape::maxKeys) return Value();
+		std::size_t h = count;
+		for (std::size_t i = 0; i < count; i++) {
+			//long keys are not interned
+			if (entries[i].getKey().size() > KeyTable::maxKeyLength) return Value();
+			h = h * 31 + reinterpret_cast<std::uintptr_t>(static_cast<const IValue *>(entries[i].key));
+		}
+		auto iter = shapeCache.find(h);
+		if (iter == shapeCache.end()) {
+			if (shapeCache.size() >= maxCachedShapes) return Value();
+			ShapeOrder so;
+			so.order.resize(count);
+			for (std::size_t i = 0; i < count; i++) {
+				so.keys.push_back(entries[i].key);
+				so.order[i] = i;
+			}
+			std::sort(so.order.begin(), so.order.end(), [&](std::size_t a, std::size_t b) {
+				return entries[a].getKey() < entries[b].getKey();
+			});
+			tmpKeys.clear();
+			for (std::size_t i = 0; i < count; i++) {
+				if (i && entries[so.order[i]].key == tmpKeys.back()) return Value();
+				tmpKeys.push_back(entries[so.order[i]].key);
+			}
+			so.shape = Shape::get(tmpKeys.data(), count);
+			iter = shapeCache.emplace(h, std::move(so)).first;
+		} else {
+			const auto &keys = iter->second.keys;
+			if (keys.size() != count) return Value();
+			for (std::size_t i = 0; i < count; i++) {
+				if (keys[i] != entries[i].key) return Value();
+			}
+		}
+		const ShapeOrder &so = iter->second;
+		RefCntPtr<ShapeObjectValue> res = ShapeObjectValue::create(so.shape);
+		for (std::size_t i = 0; i < count; i++) {
+			res->push_back(std::move(entries[so.order[i]].value));
+		}
+		return PValue(res);
+	}
+
 	template<typename Fn>
 	inline void Parser<Fn>::freeString(const StrIdx &str)
 	{
@@ -530,6 +869,13 @@ namespace json {
 			Utf8ToWide conv;
 			conv([&]{
 				do {
+					if constexpr(contiguous) {
+						//plain characters are copied at once, they don't change state of the conversion
+						std::string_view remain = rd.getRemain();
+						std::size_t len = ParserHelper::scanPlain(remain);
+						tmpstr.insert(tmpstr.end(), remain.data(), remain.data()+len);
+						rd.skip(len);
+					}
 					int c = rd.readFast();
 					if (c == -1) {
 						throw ParseError("Unexpected end of file", c);
@@ -583,170 +929,6 @@ namespace json {
 
 
 
-	template<typename Fn>
-	inline bool Parser<Fn>::parseUnsigned(UInt & res, int &counter)
-	{
-		const UInt overflowDetection = ((UInt)-1) / 10; //429496729
-		//start at zero
-		res = 0;
-		//count read charactes
-		counter = 0;
-		//read first character
-		char c = rd.next();
-		//repeat while it is digit
-		while (isdigit(c)) {
-			if (res > overflowDetection) {
-				return false;
-			}
-			//calculate next val
-			UInt nextVal = res * 10 + (c - '0');
-			//detect overflow
-			if (nextVal < res) {
-				//report overflow (maintain already parsed value
-				return false;
-			}
-			//commit chracter
-			rd.commit();
-			//read next character
-			c = rd.next();
-			//store next value
-			res = nextVal;
-			//count character
-			counter++;
-		}
-		//found non digit character, exit parsing - number is complete
-		return true;
-	}
-
-	template<typename Fn>
-	inline double Parser<Fn>::parseLargeUnsigned(UInt intPart)
-	{
-		//starts with given integer part - convert to double
-		double res = (double)intPart;
-		//read while there are digits
-
-		int c;
-
-		while (isdigit(c = rd.next())) {
-			//prepare next unsigned integer
-			UInt part;
-			//prepare counter
-			int cnt;
-			//read next sequence of digits as integer
-			parseUnsigned(part, cnt);
-			//now res = res * 10^cnt + part 
-			//this should reduce rounding errors because count of multiplies will be minimal
-			res = floor(res * pow(10.0, cnt) + double(part));
-
-			if (std::isinf(res)) throw ParseError("Too long number", c);
-		}
-		//return the result
-		return res;
-	}
-
-
-	template<typename Fn>
-	inline double Parser<Fn>::parseDecimalPart()
-	{
-		//parses decimal part as series of unsigned number each is multipled by its position
-		double res = 0;
-		unsigned int pos = 0;
-		//lookup table is slightly faster
-		static double numbers[10] = {0.0, 1.0,2.0,3.0,4.0,5.0,6.0,7.0,8.0,9.0};
-
-		//first, read digits and create large number
-		//count of decimals
-		//collect all numbers
-		while (isdigit(rd.next())) {
-
-			//pick digit ascii
-			char c = rd.nextCommit();
-
-			//convert to index
-			unsigned int n = c - '0';
-
-			//calculate 10*prev_value + number
-			//always truncate the number to prevent rounding errors
-			res = floor(res * 10 + numbers[n]);
-
-			//increase count of decimals
-			pos ++;
-		}
-		//finally, calculate decimal point shift (as number 10^digits)
-		//we use 10 because it doesn't generate rounding errors
-		double m = pow(10,pos);
-		//one operation divide large number by m, to shift whole number behind deximal page
-		res = res / m;
-		//result
-		return res;
-	}
-
-	template<typename Fn>
-	inline Value Parser<Fn>::parseDouble(UInt intpart, bool neg)
-	{
-		//float number is in format [+/-]digits[.digits][E[+/-]digits]
-		//sign is stored in neg
-		//complete to reading integer part
-		double d = parseLargeUnsigned(intpart);
-
-		int c = rd.next();
-		//if next char is dot
-		if (c == '.') {
-			//commit dot
-			rd.commit();
-			//next character must be a digit
-			if (isdigit(c = rd.next())) {
-				//so parse decimal part
-				double frac = parseDecimalPart();
-				//combine with integer part
-				d = d + frac;
-			}
-			else {
-				//throw exception that next character is not digit
-				throw ParseError("Expected '0'...'9' after '.'", c);
-			}
-			c = rd.next();
-		}
-		//next character is 'E' (exponent part)
-		if (toupper(c) == 'E') {
-			//commit the 'E'
-			rd.commit();
-			//read and discard any possible sign
-			bool negexp = readSign();
-			//prepare integer exponent
-			UInt expn;
-			//prepare counter (we don't need it)
-			int counter;
-			//next character must be a digit
-			if (!isdigit(c = rd.next()))
-				//throw exception is doesn't it
-				throw ParseError("Expected '0'...'9' after 'E'", c);
-			//parse the exponent
-			if (!parseUnsigned(expn, counter))
-				//complain about too large exponent (two or three digits must match to UInt)
-				throw ParseError("Exponent is too large", c);
-			//if exponent is negative
-			if (negexp) {
-				//calculate d * 0.1^expn
-				d = d * pow(0.1, expn);
-			}
-			else {
-				//calculate d * 10^expn
-				d = d * pow(10.0, expn);
-			}			
-		}
-		//negative value
-		if (neg) {
-			//return negative
-			return Value(-d);
-		} 
-		else {
-			//return positive
-			return Value(d);
-		}
-	}
-
-
 	template<typename Fn>
 	typename Parser<Fn>::StrIdx Parser<Fn>::parsePreciseNumber(bool& hint_is_float) {
 		UInt start = tmpstr.size();
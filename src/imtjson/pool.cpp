@@ -0,0 +1,216 @@
+#include <new>
+#include <mutex>
+#include <algorithm>
+#include "pool.h"
+#include "chunkMap.h"
+
+namespace json {
+
+	static const std::size_t sizeClasses[] = {
+			16,32,48,64,80,96,112,128,160,192,224,256,320,384,448,512
+	};
+
+	static const unsigned int classCount = sizeof(sizeClasses)/sizeof(sizeClasses[0]);
+
+	///Maps size (divided by 16 and rounded up) to the size class
+	struct ClassTable {
+		unsigned char index[PoolAllocator::maxBlockSize/16+1];
+		constexpr ClassTable():index() {
+			unsigned int c = 0;
+			for (std::size_t i = 0; i <= PoolAllocator::maxBlockSize/16; i++) {
+				while (sizeClasses[c] < i * 16) c++;
+				index[i] = static_cast<unsigned char>(c);
+			}
+		}
+	};
+
+	static constexpr ClassTable classTable;
+
+	///Count of blocks moved between the thread cache and the depot at once
+	static std::size_t batchSize(unsigned int c) {
+		std::size_t b = 4096/sizeClasses[c];
+		return b < 16?16:b;
+	}
+
+	struct PoolSlab: public ChunkHeader {
+		unsigned int sizeClass;
+	};
+
+	static const std::size_t slabHeaderSize = (sizeof(PoolSlab) + 15) & ~std::size_t(15);
+
+	struct FreeBlock {
+		FreeBlock *next;
+		///Link to next batch (valid only on the first block of the batch in the depot)
+		FreeBlock *nextBatch;
+	};
+
+	///Global depot of free blocks
+	/** Full batches are stored as a list of batches. Blocks returned by the threads
+	 * which already exited are stored as single list of orphans
+	 */
+	struct Depot {
+		std::mutex lock;
+		FreeBlock *batches = nullptr;
+		FreeBlock *orphans = nullptr;
+	};
+
+	static Depot depot[classCount];
+
+	///Cache of free blocks of the thread
+	/** The structure is trivial, so it is still accessible during the destruction
+	 * of the thread (destructors of other thread local objects can release values)
+	 */
+	struct ThreadCache {
+		FreeBlock *list[classCount];
+		std::size_t count[classCount];
+		bool dead;
+	};
+
+	static thread_local ThreadCache cache;
+
+	///Flushes the cache to the depot when the thread exits
+	struct ThreadCacheGuard {
+		bool active = false;
+		~ThreadCacheGuard() {
+			for (unsigned int c = 0; c < classCount; c++) {
+				FreeBlock *l = cache.list[c];
+				if (l) {
+					FreeBlock *e = l;
+					while (e->next) e = e->next;
+					std::lock_guard<std::mutex> _(depot[c].lock);
+					e->next = depot[c].orphans;
+					depot[c].orphans = l;
+				}
+				cache.list[c] = nullptr;
+				cache.count[c] = 0;
+			}
+			cache.dead = true;
+		}
+	};
+
+	static thread_local ThreadCacheGuard cacheGuard;
+
+	static void releaseBlock(ChunkHeader *chunk, void *ptr);
+
+	///Allocates new slab, first batch is returned, rest is stored in the depot
+	static FreeBlock *allocSlab(unsigned int c) {
+		void *m = ChunkMap::allocChunk(ChunkMap::chunkSize);
+		if (m == nullptr) return nullptr;
+		PoolSlab *slab = reinterpret_cast<PoolSlab *>(m);
+		slab->release = &releaseBlock;
+		slab->sizeClass = c;
+
+		std::size_t sz = sizeClasses[c];
+		std::size_t bsz = batchSize(c);
+		char *beg = reinterpret_cast<char *>(m) + slabHeaderSize;
+		std::size_t cnt = (ChunkMap::chunkSize - slabHeaderSize) / sz;
+
+		FreeBlock *first = nullptr;
+		FreeBlock *batches = nullptr;
+		for (std::size_t i = 0; i < cnt; i+=bsz) {
+			std::size_t n = std::min(bsz, cnt - i);
+			FreeBlock *head = nullptr;
+			for (std::size_t j = n; j > 0; j--) {
+				FreeBlock *b = reinterpret_cast<FreeBlock *>(beg + (i+j-1)*sz);
+				b->next = head;
+				head = b;
+			}
+			if (first == nullptr) {
+				first = head;
+			} else if (n == bsz) {
+				head->nextBatch = batches;
+				batches = head;
+			} else {
+				FreeBlock *e = head;
+				while (e->next) e = e->next;
+				std::lock_guard<std::mutex> _(depot[c].lock);
+				e->next = depot[c].orphans;
+				depot[c].orphans = head;
+			}
+		}
+		if (batches) {
+			FreeBlock *e = batches;
+			while (e->nextBatch) e = e->nextBatch;
+			std::lock_guard<std::mutex> _(depot[c].lock);
+			e->nextBatch = depot[c].batches;
+			depot[c].batches = batches;
+		}
+		return first;
+	}
+
+	///Refills the cache of the thread - returns false, if there is no memory
+	static bool refill(unsigned int c) {
+		cacheGuard.active = true;
+		FreeBlock *l = nullptr;
+		std::size_t cnt = 0;
+		{
+			std::lock_guard<std::mutex> _(depot[c].lock);
+			if (depot[c].batches) {
+				l = depot[c].batches;
+				depot[c].batches = l->nextBatch;
+				cnt = batchSize(c);
+			} else if (depot[c].orphans) {
+				l = depot[c].orphans;
+				depot[c].orphans = nullptr;
+				for (FreeBlock *e = l; e; e = e->next) cnt++;
+			}
+		}
+		if (l == nullptr) {
+			l = allocSlab(c);
+			if (l == nullptr) return false;
+			cnt = batchSize(c);
+		}
+		cache.list[c] = l;
+		cache.count[c] = cnt;
+		return true;
+	}
+
+	///Moves one batch from the cache of the thread to the depot
+	static void flush(unsigned int c) {
+		std::size_t bsz = batchSize(c);
+		FreeBlock *head = cache.list[c];
+		FreeBlock *e = head;
+		for (std::size_t i = 1; i < bsz; i++) e = e->next;
+		cache.list[c] = e->next;
+		cache.count[c] -= bsz;
+		e->next = nullptr;
+		std::lock_guard<std::mutex> _(depot[c].lock);
+		head->nextBatch = depot[c].batches;
+		depot[c].batches = head;
+	}
+
+	static void releaseBlock(ChunkHeader *chunk, void *ptr) {
+		unsigned int c = static_cast<PoolSlab *>(chunk)->sizeClass;
+		FreeBlock *b = reinterpret_cast<FreeBlock *>(ptr);
+		if (cache.dead) {
+			std::lock_guard<std::mutex> _(depot[c].lock);
+			b->next = depot[c].orphans;
+			depot[c].orphans = b;
+			return;
+		}
+		if (cache.list[c] == nullptr) cacheGuard.active = true;
+		b->next = cache.list[c];
+		cache.list[c] = b;
+		if (++cache.count[c] > 2 * batchSize(c)) flush(c);
+	}
+
+	void *PoolAllocator::alloc(std::size_t sz) {
+		if (sz <= maxBlockSize && !cache.dead) {
+			unsigned int c = classTable.index[(sz + 15) >> 4];
+			if (cache.list[c] != nullptr || refill(c)) {
+				FreeBlock *b = cache.list[c];
+				cache.list[c] = b->next;
+				cache.count[c]--;
+				return b;
+			}
+		}
+		return ::operator new(sz);
+	}
+
+	void PoolAllocator::dealloc(void *ptr) {
+		ChunkHeader *chunk = ChunkMap::find(ptr);
+		if (chunk) chunk->release(chunk, ptr);
+		else ::operator delete(ptr);
+	}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+namespace json {
+
+	///Thread-caching pool allocator for small blocks
+	/** The allocator is optimized for small blocks of fixed sizes, which are
+	 * typical for the values (numbers, short strings, small containers, proxies). The
+	 * blocks are rounded up to the size class and allocated from slabs. Every thread
+	 * has own cache of free blocks for every size class, so the most of the allocations
+	 * and deallocations don't need any synchronization. Free blocks are exchanged
+	 * between threads in batches through a global depot.
+	 *
+	 * Blocks larger than maxBlockSize are allocated by the standard heap.
+	 *
+	 * The pool allocator is default allocator of the values. To use the standard heap,
+	 * change Value::allocator at the start of the program
+	 *
+	 * @code
+	 * Value::allocator = Allocator::getHeap();
+	 * @endcode
+	 *
+	 * It is safe to switch allocators even if some values are already allocated, because
+	 * the blocks of the pool are recognized and returned to the pool regardless of which
+	 * allocator is active.
+	 *
+	 * @note Slabs are never returned back to the system. Free blocks are reused for new allocations
+	 */
+	class PoolAllocator {
+	public:
+
+		///Largest block allocated from the pool
+		static const std::size_t maxBlockSize = 512;
+
+		///Allocates block
+		static void *alloc(std::size_t sz);
+		///Releases block allocated by any allocator
+		static void dealloc(void *ptr);
+	};
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include "ivalue.h"
+#include "arena.h"
+
+namespace json {
+
+	///Keeps members of an object returned with the key
+	/** Objects store keys and values separately. Members returned as values (itemAtIndex(),
+	 * member()) must carry the key, so they are wrapped to the proxy. The proxy is created on the
+	 * first access and kept until the object is destroyed, so repeated lookups don't allocate.
+	 * The table of proxies is allocated on the first access too, objects accessed only
+	 * through the borrowing functions don't need it.
+	 *
+	 * The cache can be accessed by many threads. When two threads create the same proxy,
+	 * one of them is dropped
+	 */
+	class ProxyCache {
+	public:
+		ProxyCache() {}
+		ProxyCache(const ProxyCache &) = delete;
+		ProxyCache &operator=(const ProxyCache &) = delete;
+		~ProxyCache() {clear();}
+
+		///Retrieves the proxy
+		/**
+		 * @param index index of the member
+		 * @param count count of the members of the object
+		 * @param create function which creates the proxy (returns PValue)
+		 * @return the proxy
+		 */
+		template<typename Fn>
+		PValue get(std::size_t index, std::size_t count, Fn &&create) const {
+			Table *t = table.load(std::memory_order_acquire);
+			if (t == nullptr) t = allocTable(count);
+			if (index >= t->count) return create();
+			const IValue *p = t->items[index].load(std::memory_order_acquire);
+			if (p) return p;
+			PValue n;
+			{
+				//the proxy is kept by the object, which can outlive the arena
+				ArenaSuspend noArena;
+				n = create();
+			}
+			n->publish();
+			const IValue *expected = nullptr;
+			if (t->items[index].compare_exchange_strong(expected, n, std::memory_order_acq_rel)) {
+				n->addRef();
+				return n;
+			}
+			return expected;
+		}
+
+		///Releases all proxies
+		/** Must not be called while other threads access the object */
+		void clear() {
+			Table *t = table.exchange(nullptr, std::memory_order_relaxed);
+			if (t == nullptr) return;
+			for (std::size_t i = 0; i < t->count; i++) {
+				const IValue *p = t->items[i].load(std::memory_order_relaxed);
+				if (p && p->release()) delete p;
+			}
+			delete [] t->items;
+			delete t;
+		}
+
+		///Count of bytes allocated by the cache including the proxies
+		std::size_t memorySize() const {
+			const Table *t = table.load(std::memory_order_acquire);
+			if (t == nullptr) return 0;
+			std::size_t sz = sizeof(Table) + t->count * sizeof(std::atomic<const IValue *>);
+			for (std::size_t i = 0; i < t->count; i++) {
+				const IValue *p = t->items[i].load(std::memory_order_acquire);
+				if (p) sz += p->memorySize();
+			}
+			return sz;
+		}
+
+	protected:
+		struct Table {
+			std::size_t count;
+			std::atomic<const IValue *> *items;
+		};
+
+		mutable std::atomic<Table *> table = {nullptr};
+
+		Table *allocTable(std::size_t count) const {
+			Table *t = new Table{count, new std::atomic<const IValue *>[count]()};
+			Table *expected = nullptr;
+			if (table.compare_exchange_strong(expected, t, std::memory_order_acq_rel)) return t;
+			delete [] t->items;
+			delete t;
+			return expected;
+		}
+	};
+
+}
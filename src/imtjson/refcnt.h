@@ -2,6 +2,7 @@
 #define __ONDRA_IMTJSON_REFCNT_H_pkgqgqwdkuUvgvuywefgUIGuyqwteudvw
 
 #include <atomic>
+#include <limits>
 
 namespace json {
 
@@ -15,26 +16,80 @@ namespace json {
 	public:
 
 		void addRef() const noexcept {
-			++counter;
+			long c = counter.load(std::memory_order_relaxed);
+			if (c >= immortalCount) return;
+			if (c & localFlag) counter.store(c+1, std::memory_order_relaxed);
+			else ++counter;
 		}
 
 		bool release() const noexcept {
+			long c = counter.load(std::memory_order_relaxed);
+			if (c >= immortalCount) return false;
+			if (c & localFlag) {
+				counter.store(c-1, std::memory_order_relaxed);
+				return c-1 == localFlag;
+			}
 			return --counter == 0;
 		}
 
 		RefCntObj():counter(0) {}
 
+		///Makes the object immortal
+		/** Reference counter of immortal object is no longer updated and the object is
+		 * never destroyed through the reference counting. This is intended
+		 * for static objects, which are shared by many threads. Copying references
+		 * to immortal objects doesn't need atomic operations.
+		 */
+		void setImmortal() const noexcept {
+			long c = counter.load(std::memory_order_relaxed);
+			while (c < immortalCount && !counter.compare_exchange_weak(c, c + immortalCount, std::memory_order_relaxed)) {}
+		}
+
+		///Returns true, if the object is immortal
+		bool isImmortal() const noexcept {
+			return counter.load(std::memory_order_relaxed) >= immortalCount;
+		}
+
+		///Marks the object as thread local
+		/** Reference counter of thread local object is updated without atomic operations. Such object
+		 * must not be accessed by other threads until it is published
+		 *
+		 * @note it should be called only before the first reference is created
+		 */
+		void setLocal() const noexcept {
+			counter.store(counter.load(std::memory_order_relaxed) | localFlag, std::memory_order_relaxed);
+		}
+
+		///Publishes thread local object, so it can be shared with other threads
+		/** Function must be called by the thread which owns the object. */
+		void publish() const noexcept {
+			long c = counter.load(std::memory_order_relaxed);
+			if (c < immortalCount && (c & localFlag)) {
+				counter.store(c & ~localFlag, std::memory_order_release);
+			}
+		}
+
+		///Returns true, if the object is thread local
+		bool isLocal() const noexcept {
+			long c = counter.load(std::memory_order_relaxed);
+			return c < immortalCount && (c & localFlag) != 0;
+		}
+
 		bool isShared() const {
-			return counter > 1;
+			return use_count() > 1;
 		}
 
 		long use_count() const noexcept {
-			return counter;
+			long c = counter.load();
+			return c < immortalCount?(c & ~localFlag):c;
 		}
 
 	protected:
 		mutable std::atomic_long counter;
 
+		static constexpr long immortalCount = std::numeric_limits<long>::max()/2+1;
+		static constexpr long localFlag = immortalCount/2;
+
 
 		template<typename T> friend class RefCntPtr;
 	};
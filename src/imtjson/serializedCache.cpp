@@ -0,0 +1,186 @@
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "serializedCache.h"
+#include "key.h"
+#include "arena.h"
+
+namespace json {
+
+	///Container which remembers its serialized text
+	/** The value is transparent, it forwards everything to the original container. It only
+	 * adds the flag serializedCached. It is not a proxy, so it stays in place when it is
+	 * inserted to other containers.
+	 *
+	 * The texts are owned by the SerializedCache, the value only points to them, so the lookup
+	 * doesn't need to lock the cache. The cache clears the pointer before it releases the text
+	 * and waits until the readers, which could have seen the old pointer, take their reference.
+	 */
+	class SerializedCachedValue: public AbstractProxy {
+	public:
+		using AbstractProxy::AbstractProxy;
+		~SerializedCachedValue() {SerializedCache::remove(this);}
+
+		virtual ValueTypeFlags flags() const override { return value->flags() | serializedCached; }
+		///Cached texts are not included
+		virtual std::size_t memorySize() const override {return sizeof(SerializedCachedValue);}
+		virtual const IValue *unproxy() const override { return this; }
+		virtual bool equal(const IValue *other) const override {
+			return other == this || value->equal(other->unproxy());
+		}
+		virtual int compare(const IValue *other) const override {
+			return value->compare(other);
+		}
+
+		String getText(bool utf8) const {
+			String res;
+			readers.fetch_add(1);
+			const IValue *t = texts[utf8].load();
+			if (t) res = String(Value(PValue(t)));
+			readers.fetch_sub(1);
+			if (t && !used[utf8].load(std::memory_order_relaxed))
+				used[utf8].store(true, std::memory_order_relaxed);
+			return res;
+		}
+		bool hasText(bool utf8) const {
+			return texts[utf8].load(std::memory_order_relaxed) != nullptr;
+		}
+		void setText(bool utf8, const IValue *t) const {
+			used[utf8].store(false, std::memory_order_relaxed);
+			texts[utf8].store(t);
+		}
+		///Detaches the text. After return, nobody can take a new reference to it
+		void resetText(bool utf8) const {
+			texts[utf8].store(nullptr);
+			while (readers.load()) std::this_thread::yield();
+		}
+		///Retrieves and clears the flag which is set by every lookup
+		bool wasUsed(bool utf8) const {
+			return used[utf8].exchange(false, std::memory_order_relaxed);
+		}
+
+	protected:
+		mutable std::atomic<const IValue *> texts[2] = {};
+		mutable std::atomic<bool> used[2] = {};
+		mutable std::atomic<unsigned int> readers = {0};
+	};
+
+	struct SerializedCacheEntry {
+		const SerializedCachedValue *v;
+		bool utf8;
+		String text;
+	};
+
+	struct SerializedCacheKey {
+		const IValue *v;
+		bool utf8;
+		bool operator==(const SerializedCacheKey &other) const {return v == other.v && utf8 == other.utf8;}
+	};
+
+	struct SerializedCacheKeyHash {
+		std::size_t operator()(const SerializedCacheKey &k) const {
+			return std::hash<const IValue *>()(k.v) ^ static_cast<std::size_t>(k.utf8);
+		}
+	};
+
+	struct SerializedCacheState {
+		std::mutex lock;
+		///Most recently stored entry is at front
+		std::list<SerializedCacheEntry> lru;
+		std::unordered_map<SerializedCacheKey, std::list<SerializedCacheEntry>::iterator, SerializedCacheKeyHash> index;
+		std::size_t budget = SerializedCache::defaultBudget;
+		std::size_t used = 0;
+
+		void erase(std::list<SerializedCacheEntry>::iterator iter) {
+			iter->v->resetText(iter->utf8);
+			used -= iter->text.length();
+			index.erase(SerializedCacheKey{iter->v, iter->utf8});
+			lru.erase(iter);
+		}
+
+		///Evicts entries from the back. Entries used since the last pass get second chance
+		void evict(std::size_t limit) {
+			std::size_t chances = lru.size();
+			while (used > limit) {
+				auto iter = std::prev(lru.end());
+				if (chances && iter->v->wasUsed(iter->utf8)) {
+					--chances;
+					lru.splice(lru.begin(), lru, iter);
+				} else {
+					erase(iter);
+				}
+			}
+		}
+	};
+
+	///State is never destroyed, so values can be released during the exit of the program
+	static SerializedCacheState &getState() {
+		static SerializedCacheState *state = new SerializedCacheState;
+		return *state;
+	}
+
+	static const SerializedCachedValue *getCachedValue(const IValue *v) {
+		return static_cast<const SerializedCachedValue *>(v->unproxy());
+	}
+
+	String SerializedCache::lookup(const IValue *v, bool utf8) {
+		return getCachedValue(v)->getText(utf8);
+	}
+
+	void SerializedCache::store(const IValue *v, bool utf8, const std::string_view &text) {
+		const SerializedCachedValue *cv = getCachedValue(v);
+		String str;
+		{
+			ArenaSuspend noArena;
+			str = String(text);
+		}
+		str.getHandle()->publish();
+		SerializedCacheState &st = getState();
+		std::lock_guard<std::mutex> _(st.lock);
+		if (text.size() > st.budget || cv->hasText(utf8)) return;
+		st.evict(st.budget - text.size());
+		st.lru.push_front(SerializedCacheEntry{cv, utf8, str});
+		st.index.emplace(SerializedCacheKey{cv, utf8}, st.lru.begin());
+		st.used += text.size();
+		cv->setText(utf8, str.getHandle());
+	}
+
+	void SerializedCache::remove(const IValue *v) {
+		SerializedCacheState &st = getState();
+		std::lock_guard<std::mutex> _(st.lock);
+		for (bool utf8: {false, true}) {
+			auto iter = st.index.find(SerializedCacheKey{v, utf8});
+			if (iter != st.index.end()) st.erase(iter->second);
+		}
+	}
+
+	void SerializedCache::clear() {
+		SerializedCacheState &st = getState();
+		std::lock_guard<std::mutex> _(st.lock);
+		while (!st.lru.empty()) st.erase(st.lru.begin());
+	}
+
+	void SerializedCache::setBudget(std::size_t bytes) {
+		SerializedCacheState &st = getState();
+		std::lock_guard<std::mutex> _(st.lock);
+		st.budget = bytes;
+		st.evict(bytes);
+	}
+
+	std::size_t SerializedCache::usage() {
+		SerializedCacheState &st = getState();
+		std::lock_guard<std::mutex> _(st.lock);
+		return st.used;
+	}
+
+	Value Value::cacheSerialized() const {
+		ValueType t = type();
+		if ((t != object && t != array) || (flags() & serializedCached)) return *this;
+		Value res(PValue(new SerializedCachedValue(v->unproxy())));
+		if (flags() & proxy) return Value(getKey(), res);
+		else return res;
+	}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include "string.h"
+
+namespace json {
+
+	///Process-wide cache of serialized containers
+	/** The cache keeps the serialized text of containers marked by Value::cacheSerialized(). When such
+	 * container is serialized again, the serializer copies the text instead of walking the
+	 * subtree. The text is kept separately for each UnicodeFormat.
+	 *
+	 * Total size of the cached texts is limited by the budget. When the budget is exceeded,
+	 * the oldest texts which were not used since the previous eviction are evicted. They are
+	 * created again by the next serialization. Texts of a container are also removed when
+	 * the container is destroyed
+	 *
+	 * The container points directly to its texts, so the lookup doesn't lock the cache and
+	 * threads which serialize the same container don't wait for each other. The lock is held
+	 * only while a text is stored or removed
+	 *
+	 * @note changing maxPrecisionDigits doesn't invalidate the cached texts. Call clear() in this case
+	 */
+	class SerializedCache {
+	public:
+
+		///Default budget in bytes
+		static const std::size_t defaultBudget = 16*1024*1024;
+
+		///Retrieves cached text
+		/**
+		 * @param v container. It must be a value created by Value::cacheSerialized()
+		 * @param utf8 true for the text serialized with emitUtf8, false for emitEscaped
+		 * @return cached text, or empty string, if there is no text for the container
+		 */
+		static String lookup(const IValue *v, bool utf8);
+		///Stores text to the cache
+		/**
+		 * @param v container. It must be a value created by Value::cacheSerialized()
+		 * @param utf8 true for the text serialized with emitUtf8, false for emitEscaped
+		 * @param text serialized text. If other thread stored the text meanwhile, the text is dropped
+		 */
+		static void store(const IValue *v, bool utf8, const std::string_view &text);
+		///Removes texts of the container
+		static void remove(const IValue *v);
+		///Removes all texts
+		static void clear();
+
+		///Sets the budget
+		/** @param bytes maximum total size of the cached texts. Zero disables the cache */
+		static void setBudget(std::size_t bytes);
+		///Retrieves total size of the cached texts
+		static std::size_t usage();
+	};
+
+}
@@ -3,24 +3,94 @@
 #include <string_view>
 #include <cstdlib>
 #include <cmath>
+#include <type_traits>
 #include <vector>
 #include "value.h"
 #include "binary.h"
 #include "utf8.h"
+#include "packedArray.h"
+#include "serializedCache.h"
 
 namespace json {
 
 	///Configures precision of floating numbers
-	/** Global variable specifies count of decimal digits of float numbers. 
-	The default value is 9 and 9 is also maximum.
+	/** Global variable specifies count of decimal digits of float numbers.
+	The default value is 9 and 9 is also maximum. Set shortestPrecision to emit
+	the shortest text that is parsed back to the same double.
 	*/
 	extern uintptr_t maxPrecisionDigits;
+	///Value of maxPrecisionDigits which selects the shortest round-trip format
+	/** The format is exact, but it is slower than the rounded format */
+	static const uintptr_t shortestPrecision = 0;
+	///Formats finite non-negative double as the shortest text which is parsed back to the same double
+	/** The text uses the same layout as the rounded format: decimal exponents from -2 to 7 are written
+	 * as decimal numbers without exponent, so integers below 1e8 don't contain a dot nor an exponent.
+	 * Other numbers are written as 1.2345e+20 or 1.2345e-20, so 0.001 is written as 1e-3.
+	 *
+	 * The digits come from std::to_chars. If the library doesn't provide it, the function
+	 * searches the shortest precision through snprintf and strtod, which is much slower.
+	 *
+	 * @param value value to format
+	 * @param buff buffer for at least 32 characters
+	 * @return length of the text
+	 */
+	std::size_t formatShortestDouble(double value, char *buff);
 	///Specifies default output format for unicode character during serialization
 	/** If output format is not specified by serialization function. Default
 	is emitEscaped*/
 	extern UnicodeFormat defaultUnicodeFormat;
 
 
+	///Two decimal digits of every number 0...99
+	inline constexpr char digitPairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+	///Size of the buffer for formatUnsignedDigits(), enough for any 64-bit number and a sign
+	static const std::size_t numberBufferSize = 24;
+
+	///Formats unsigned number to decimal digits, two digits per step
+	/**
+	 * @param value number to format
+	 * @param end end of the buffer. The digits are written backwards, the buffer must have
+	 *   at least numberBufferSize characters
+	 * @return pointer to the first digit
+	 */
+	template<typename T>
+	inline char *formatUnsignedDigits(T value, char *end) {
+		while (value >= 100) {
+			unsigned int i = static_cast<unsigned int>(value % 100) * 2;
+			value /= 100;
+			end -= 2;
+			end[0] = digitPairs[i];
+			end[1] = digitPairs[i+1];
+		}
+		if (value >= 10) {
+			unsigned int i = static_cast<unsigned int>(value) * 2;
+			end -= 2;
+			end[0] = digitPairs[i];
+			end[1] = digitPairs[i+1];
+		} else {
+			*--end = static_cast<char>('0' + value);
+		}
+		return end;
+	}
+
+	///Detects target which is able to write a block of characters
+	/** Such target has a member function write(std::string_view) in addition to the operator() */
+	template<typename Fn, typename = void>
+	struct HasBulkWrite: std::false_type {};
+	template<typename Fn>
+	struct HasBulkWrite<Fn, std::void_t<decltype(std::declval<std::remove_reference_t<Fn> &>().write(std::string_view()))> >: std::true_type {};
+
+	///Serializer's target which appends the output to a string
+	class StringifyTarget {
+	public:
+		StringifyTarget(std::string &buff):buff(buff) {}
+		void operator()(char c) {buff.push_back(c);}
+		void write(const std::string_view &text) {buff.append(text);}
+	protected:
+		std::string &buff;
+	};
+
 	template<typename Fn>
 	class Serializer {
 	public:
@@ -39,23 +109,38 @@ namespace json {
 		void serializeBoolean(const IValue *ptr);
 		void serializeNull(const IValue *ptr);
 
-		void serializeKeyValue(const IValue *ptr);
+		void serializeKeyValue(const std::string_view &name, const IValue *ptr);
+		///Serializes member of an object at given index
+		void serializeMember(const IValue *obj, std::size_t index);
+		///Serializes packed array without materializing the items
+		/** @retval false not a packed array of given type */
+		template<typename T>
+		bool serializePacked(const IValue *ptr);
+		///Serializes packed string array without materializing the items
+		/** @retval false not a packed string array */
+		bool serializePackedStrings(const IValue *ptr);
 
 	protected:
 		Fn target;
 		bool utf8output;
 
+		template<typename> friend class Serializer;
+
+		///Serializes container which remembers its serialized text
+		void serializeCached(const IValue *ptr);
+		void writeObject(const IValue *ptr);
+		void writeArray(const IValue *ptr);
+
 		void write(const std::string_view &text);
 		void writeUnsigned(UInt value);
-		void writeUnsignedRec(UInt value);
 		void writeUnsignedLong(ULongInt value);
-		void writeUnsignedRecLong(ULongInt value);
 		void writeUnsigned(UInt value, UInt digits);
 		void writeSigned(Int value);
 		void writeSignedLong(LongInt value);
 		void writeDouble(double value);
 		void writeUnicode(unsigned int uchar);
 		void writeString(const std::string_view &text);
+		void writePlainString(const std::string_view &text);
 		void writeStringBody(const std::string_view &text);
 		void writePreciseNumber(const std::string_view &text);
 
@@ -104,24 +189,40 @@ namespace json {
 	}
 
 	template<typename Fn>
-	inline void Serializer<Fn>::serializeKeyValue(const IValue * ptr) {
-		std::string_view name = ptr->getMemberName();
+	inline void Serializer<Fn>::serializeKeyValue(const std::string_view &name, const IValue * ptr) {
 		writeString(name);
 		target(':');
 		serialize(ptr);
 
 	}
 
+	template<typename Fn>
+	inline void Serializer<Fn>::serializeMember(const IValue *obj, std::size_t index) {
+		ItemRef item(obj, index);
+		const IValue *key = obj->memberKeyAtIndex(index);
+		if (key && (key->flags() & plainString)) writePlainString(key->getString());
+		else writeString(item.getMemberName());
+		target(':');
+		serialize(item);
+	}
+
 	template<typename Fn>
 	inline void Serializer<Fn>::serializeObject(const IValue * ptr)
+	{
+		if (ptr->flags() & serializedCached) serializeCached(ptr);
+		else writeObject(ptr);
+	}
+
+	template<typename Fn>
+	inline void Serializer<Fn>::writeObject(const IValue * ptr)
 	{
 		target('{');
 		auto cnt = ptr->size();
 		if (cnt) {
-			serializeKeyValue(ptr->itemAtIndex(0));
+			serializeMember(ptr, 0);
 			for (decltype(cnt) i = 1; i < cnt; i++) {
 				target(',');
-				serializeKeyValue(ptr->itemAtIndex(i));
+				serializeMember(ptr, i);
 			}
 		}
 		target('}');
@@ -130,18 +231,82 @@ namespace json {
 	template<typename Fn>
 	inline void Serializer<Fn>::serializeArray(const IValue * ptr)
 	{
+		if (ptr->flags() & serializedCached) serializeCached(ptr);
+		else writeArray(ptr);
+	}
+
+	template<typename Fn>
+	inline void Serializer<Fn>::serializeCached(const IValue * ptr)
+	{
+		String text = SerializedCache::lookup(ptr, utf8output);
+		if (text.empty()) {
+			std::string buff;
+			Serializer<StringifyTarget> sub(StringifyTarget(buff), utf8output);
+			if (ptr->type() == object) sub.writeObject(ptr);
+			else sub.writeArray(ptr);
+			SerializedCache::store(ptr, utf8output, buff);
+			write(buff);
+		} else {
+			write(text);
+		}
+	}
+
+	template<typename Fn>
+	inline void Serializer<Fn>::writeArray(const IValue * ptr)
+	{
+		ValueTypeFlags f = ptr->flags();
+		if ((f & packedNumbers)
+				&& (serializePacked<double>(ptr) || serializePacked<LongInt>(ptr) || serializePacked<ULongInt>(ptr))) return;
+		if ((f & packedStrings) && serializePackedStrings(ptr)) return;
 		target('[');
 		auto cnt = ptr->size();
 		if (cnt) {
-			serialize((const IValue *)ptr->itemAtIndex(0));
+			serialize(ItemRef(ptr, 0));
 			for (decltype(cnt) i = 1; i < cnt; i++) {
 				target(',');
-				serialize((const IValue *)ptr->itemAtIndex(i));
+				serialize(ItemRef(ptr, i));
 			}
 		}
 		target(']');
 	}
 
+	template<typename Fn>
+	template<typename T>
+	inline bool Serializer<Fn>::serializePacked(const IValue * ptr)
+	{
+		const PackedArrayValue<T> *arr = PackedArrayValue<T>::cast(ptr);
+		if (arr == nullptr) return false;
+		const T *d = arr->data();
+		std::size_t cnt = arr->size();
+		target('[');
+		for (std::size_t i = 0; i < cnt; i++) {
+			if (i) target(',');
+			if constexpr(std::is_same<T, double>::value) writeDouble(d[i]);
+			else if constexpr(std::is_same<T, LongInt>::value) writeSignedLong(d[i]);
+			else writeUnsignedLong(d[i]);
+		}
+		target(']');
+		return true;
+	}
+
+	template<typename Fn>
+	inline bool Serializer<Fn>::serializePackedStrings(const IValue * ptr)
+	{
+		const PackedStringArrayValue *arr = PackedStringArrayValue::cast(ptr);
+		if (arr == nullptr) return false;
+		PackedStringsView strs = arr->getStrings();
+		std::size_t cnt = strs.size();
+		bool plain = (arr->flags() & plainString) != 0;
+		target('[');
+		for (std::size_t i = 0; i < cnt; i++) {
+			if (i) target(',');
+			if (plain) writePlainString(strs[i]);
+			else writeString(strs[i]);
+		}
+		target(']');
+		return true;
+	}
+
 	template<typename Fn>
 	inline void Serializer<Fn>::serializeNumber(const IValue * ptr)
 	{
@@ -173,6 +338,8 @@ namespace json {
 			target('"');
 			enc->encodeBinaryValue(map_str2bin(str), [&](const std::string_view &str) {writeStringBody(str);});
 			target('"');
+		} else if (ptr->flags() & plainString) {
+			writePlainString(str);
 		} else {
 			writeString(str);
 		}
@@ -193,66 +360,59 @@ namespace json {
 	template<typename Fn>
 	inline void Serializer<Fn>::write(const std::string_view& text)
 	{
-		for (auto &&x : text) target(x);
-	}
-
-	template<typename Fn>
-	inline void Serializer<Fn>::writeUnsignedRec(UInt value) {
-		if (value) {
-			writeUnsignedRec(value / 10);
-			target('0' + (value % 10));
+		if constexpr(HasBulkWrite<Fn>::value) {
+			target.write(text);
+		} else {
+			for (auto &&x : text) target(x);
 		}
 	}
 
 	template<typename Fn>
 	inline void Serializer<Fn>::writeUnsigned(UInt value)
 	{
-		if (value) writeUnsignedRec(value);
-		else target('0');
-	}
-	template<typename Fn>
-	inline void Serializer<Fn>::writeUnsignedRecLong(ULongInt value) {
-		if (value) {
-			writeUnsignedRecLong(value / 10);
-			target('0' + (value % 10));
-		}
+		char buff[numberBufferSize];
+		char *end = buff + numberBufferSize;
+		char *beg = formatUnsignedDigits(value, end);
+		write(std::string_view(beg, end - beg));
 	}
 
 	template<typename Fn>
 	inline void Serializer<Fn>::writeUnsignedLong(ULongInt value)
 	{
-		if (value) writeUnsignedRecLong(value);
-		else target('0');
+		char buff[numberBufferSize];
+		char *end = buff + numberBufferSize;
+		char *beg = formatUnsignedDigits(value, end);
+		write(std::string_view(beg, end - beg));
 	}
 
 	template<typename Fn>
 	inline void Serializer<Fn>::writeUnsigned(UInt value, UInt digits)
 	{
-		if (digits>1) writeUnsigned(value/10,digits-1);
-		target('0'+(value % 10));
+		char buff[numberBufferSize];
+		char *end = buff + numberBufferSize;
+		char *beg = formatUnsignedDigits(value, end);
+		while (static_cast<UInt>(end - beg) < digits) *--beg = '0';
+		write(std::string_view(beg, end - beg));
 	}
 
 	template<typename Fn>
 	inline void Serializer<Fn>::writeSigned(Int value)
 	{
-		if (value < 0) {
-			target('-');
-			writeUnsigned(-value);
-		}
-		else {
-			writeUnsigned(value);
-		}
+		char buff[numberBufferSize];
+		char *end = buff + numberBufferSize;
+		//negation in unsigned arithmetic doesn't overflow for the lowest value
+		char *beg = formatUnsignedDigits(value < 0?UInt(0) - static_cast<UInt>(value):static_cast<UInt>(value), end);
+		if (value < 0) *--beg = '-';
+		write(std::string_view(beg, end - beg));
 	}
 	template<typename Fn>
 	inline void Serializer<Fn>::writeSignedLong(LongInt value)
 	{
-		if (value < 0) {
-			target('-');
-			writeUnsignedLong(-value);
-		}
-		else {
-			writeUnsignedLong(value);
-		}
+		char buff[numberBufferSize];
+		char *end = buff + numberBufferSize;
+		char *beg = formatUnsignedDigits(value < 0?ULongInt(0) - static_cast<ULongInt>(value):static_cast<ULongInt>(value), end);
+		if (value < 0) *--beg = '-';
+		write(std::string_view(beg, end - beg));
 	}
 
 
@@ -281,6 +441,13 @@ namespace json {
 		const char *inf = "Inf";
 
 		bool sign = value < 0;
+		if (maxPrecisionDigits == shortestPrecision) {
+			char buff[32];
+			std::size_t len = formatShortestDouble(std::abs(value), buff);
+			if (sign) target('-');
+			write(std::string_view(buff, len));
+			return;
+		}
 		UInt precisz = std::min<UInt>(maxPrecisionDigits, 9);
 
 		value = std::abs(value);
@@ -397,9 +564,17 @@ namespace json {
 		target('"');
 	}
 
+	template<typename Fn>
+	inline void Serializer<Fn>::writePlainString(const std::string_view& text)
+	{
+		target('"');
+		write(text);
+		target('"');
+	}
+
 	template<typename Fn>
 	inline void Serializer<Fn>::writePreciseNumber(const std::string_view& text) {
-		for (auto c: text) target(c);
+		write(text);
 	}
 
 	template<typename Fn>
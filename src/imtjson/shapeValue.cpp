@@ -0,0 +1,136 @@
+#include <mutex>
+#include <unordered_map>
+#include "shapeValue.h"
+#include "key.h"
+#include "objectValue.h"
+
+namespace json {
+
+	///Table is split to shards to reduce lock contention
+	static const std::size_t shardCount = 16;
+	///Minimal size of the shard before it is swept
+	static const std::size_t minSweepSize = 64;
+
+	static std::size_t shapeHash(const PValue *keys, std::size_t count) {
+		std::size_t h = count;
+		for (std::size_t i = 0; i < count; i++) {
+			h = h * 31 + reinterpret_cast<std::uintptr_t>(static_cast<const IValue *>(keys[i]));
+		}
+		return h;
+	}
+
+	struct ShapeShard {
+		std::mutex lock;
+		std::unordered_multimap<std::size_t, PShape> shapes;
+		std::size_t sweepSize = minSweepSize;
+
+		void sweep() {
+			for (auto iter = shapes.begin(); iter != shapes.end();) {
+				//the table holds the only reference. Nobody else can add a reference without the lock
+				if (iter->second.use_count() == 1) iter = shapes.erase(iter);
+				else ++iter;
+			}
+			sweepSize = std::max(minSweepSize, shapes.size() * 2);
+		}
+
+		static bool match(const Shape &s, const PValue *keys, std::size_t count) {
+			if (s.keys.size() != count) return false;
+			for (std::size_t i = 0; i < count; i++) {
+				if (s.keys[i] != keys[i]) return false;
+			}
+			return true;
+		}
+	};
+
+	///Shards are never destroyed, so shapes can be used during the exit of the program
+	static ShapeShard *getShapeShards() {
+		static ShapeShard *shards = new ShapeShard[shardCount];
+		return shards;
+	}
+
+	Shape::Shape(const PValue *keys, std::size_t count):keys(keys, keys+count) {
+		index.build(count, [&](std::size_t i) {return keyAt(i);}, count >= ObjectValue::hashThreshold);
+	}
+
+	PShape Shape::get(const PValue *keys, std::size_t count) {
+		std::size_t h = shapeHash(keys, count);
+		ShapeShard &shard = getShapeShards()[h % shardCount];
+		std::lock_guard<std::mutex> _(shard.lock);
+		auto rng = shard.shapes.equal_range(h);
+		for (auto iter = rng.first; iter != rng.second; ++iter) {
+			if (ShapeShard::match(*iter->second, keys, count)) return iter->second;
+		}
+		if (shard.shapes.size() >= shard.sweepSize) shard.sweep();
+		PShape s = new Shape(keys, count);
+		shard.shapes.emplace(h, s);
+		return s;
+	}
+
+	void Shape::sweep() {
+		ShapeShard *shards = getShapeShards();
+		for (std::size_t i = 0; i < shardCount; i++) {
+			std::lock_guard<std::mutex> _(shards[i].lock);
+			shards[i].sweep();
+		}
+	}
+
+	std::size_t Shape::find(const std::string_view &name) const {
+		std::size_t i = index.find(name);
+		return i < index.count?i:npos;
+	}
+
+	ShapeObjectValue::ShapeObjectValue(AllocInfo &info, const PShape &shape)
+		:Container<PValue>(info),shape(shape) {}
+
+	std::size_t ShapeObjectValue::size() const {
+		return curSize;
+	}
+
+	RefCntPtr<const IValue> ShapeObjectValue::itemAtIndex(std::size_t index) const {
+		if (index < curSize) return proxies.get(index, capacity, [&]{
+			return PValue(new ObjectProxyString(String(Value(shape->keyHandle(index))), items[index]));
+		});
+		return getUndefined();
+	}
+
+	RefCntPtr<const IValue> ShapeObjectValue::member(const std::string_view &name) const {
+		std::size_t idx = shape->find(name);
+		if (idx < curSize) return itemAtIndex(idx);
+		return getUndefined();
+	}
+
+	const IValue *ShapeObjectValue::borrowAtIndex(std::size_t index) const {
+		if (index < curSize) return items[index];
+		return getUndefined();
+	}
+
+	const IValue *ShapeObjectValue::borrowMember(const std::string_view &name) const {
+		std::size_t idx = shape->find(name);
+		if (idx < curSize) return items[idx];
+		return getUndefined();
+	}
+
+	StringView ShapeObjectValue::memberNameAtIndex(std::size_t index) const {
+		if (index < curSize) return shape->keyAt(index);
+		return StringView();
+	}
+
+	const IValue *ShapeObjectValue::memberKeyAtIndex(std::size_t index) const {
+		if (index < curSize) return shape->keyHandle(index);
+		return nullptr;
+	}
+
+	bool ShapeObjectValue::forEachRef(const IEnumFn &fn) const {
+		//keys are owned by the shape, they are interned
+		for (const PValue &v: *this) {
+			if (!fn(v)) return false;
+		}
+		return true;
+	}
+
+	RefCntPtr<ShapeObjectValue> ShapeObjectValue::create(const PShape &shape) {
+		AllocInfo nfo(shape->size());
+		return new(nfo) ShapeObjectValue(nfo, shape);
+	}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include "basicValues.h"
+#include "container.h"
+#include "objectIndex.h"
+#include "proxyCache.h"
+
+namespace json {
+
+	class Shape;
+
+	typedef RefCntPtr<Shape> PShape;
+
+	///Shared sorted set of keys of objects with the same structure
+	/** Objects with the same keys (typical for records returned by an API) can share the
+	 * shape. The shape keeps the keys, the objects keep only the values. Shapes are
+	 * registered in a process-wide table, so equal shapes are shared even
+	 * between documents. Keys of the shape must be interned (see KeyTable)
+	 *
+	 * The shape is immutable
+	 */
+	class Shape: public RefCntObj {
+	public:
+
+		///Maximum count of keys of the shape
+		static const std::size_t maxKeys = 64;
+
+		///Retrieves shape for given keys
+		/**
+		 * @param keys keys of the object. They must be sorted, without duplicates, and
+		 * interned
+		 * @param count count of keys
+		 * @return shared shape
+		 */
+		static PShape get(const PValue *keys, std::size_t count);
+
+		///Count of keys
+		std::size_t size() const {return keys.size();}
+		///Key at index
+		StringView keyAt(std::size_t index) const {return keys[index]->getString();}
+		///String value of the key at index
+		const PValue &keyHandle(std::size_t index) const {return keys[index];}
+		///Finds the key
+		/** The shape is indexed when it is created (see ObjectIndex). Shapes
+		 * with ObjectValue::hashThreshold keys or more use the hash table
+		 *
+		 * @param name name of the key
+		 * @return index of the key, or npos, if not found
+		 */
+		std::size_t find(const std::string_view &name) const;
+
+		///Removes shapes which are not used anymore
+		static void sweep();
+
+		static const std::size_t npos = static_cast<std::size_t>(-1);
+
+	protected:
+		Shape(const PValue *keys, std::size_t count);
+
+		std::vector<PValue> keys;
+		ObjectIndex index;
+
+		friend struct ShapeShard;
+	};
+
+	///Object which shares keys with other objects through the Shape
+	class ShapeObjectValue : public AbstractObjectValue, public Container<PValue> {
+	public:
+
+		typedef Container<PValue>::AllocInfo AllocInfo;
+
+		ShapeObjectValue(AllocInfo &info, const PShape &shape);
+
+		virtual std::size_t size() const override;
+		virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const override;
+		virtual RefCntPtr<const IValue> member(const std::string_view &name) const override;
+		virtual const IValue *borrowAtIndex(std::size_t index) const override;
+		virtual const IValue *borrowMember(const std::string_view &name) const override;
+		virtual StringView memberNameAtIndex(std::size_t index) const override;
+		virtual const IValue *memberKeyAtIndex(std::size_t index) const override;
+		virtual bool forEachRef(const IEnumFn &fn) const override;
+		///The shape is not included, it is shared by many objects
+		virtual std::size_t memorySize() const override {return sizeof(ShapeObjectValue) + capacity * sizeof(PValue) + proxies.memorySize();}
+
+		virtual bool getBool() const override {return true;}
+
+		///Retrieves the shape
+		const PShape &getShape() const {return shape;}
+
+		///Creates object of given shape, values must be pushed in order of the keys
+		static RefCntPtr<ShapeObjectValue> create(const PShape &shape);
+
+		using Container<PValue>::operator new;
+		using Container<PValue>::operator delete;
+
+	protected:
+		PShape shape;
+		///Members returned with the key
+		ProxyCache proxies;
+	};
+
+}
@@ -0,0 +1,16 @@
+#include "sharedBuffer.h"
+
+namespace json {
+
+	PSharedBuffer SharedBuffer::create(std::string &&str) {
+		Owned<std::string> *b = new Owned<std::string>(std::string_view(), std::move(str));
+		//the content can be moved along with the string (short strings)
+		b->data = b->owner;
+		return b;
+	}
+
+	PSharedBuffer SharedBuffer::copy(const std::string_view &str) {
+		return create(std::string(str));
+	}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include "refcnt.h"
+
+namespace json {
+
+	class SharedBuffer;
+
+	typedef RefCntPtr<const SharedBuffer> PSharedBuffer;
+
+	///Immutable reference counted buffer
+	/** The buffer holds a source of the parser. Strings parsed by Value::fromBuffer() can refer
+	 * to the content of the buffer instead of copying it. The buffer is released
+	 * when the last such string is released.
+	 *
+	 * The buffer can own its content (std::string), or it can keep an owner of the
+	 * content (for example std::shared_ptr<char[]> or a handle of mapped file)
+	 */
+	class SharedBuffer: public RefCntObj {
+	public:
+
+		virtual ~SharedBuffer() {}
+
+		///Retrieves content of the buffer
+		std::string_view getData() const {return data;}
+
+		///Creates buffer which owns the string
+		static PSharedBuffer create(std::string &&str);
+		///Creates buffer which contains a copy of the data
+		static PSharedBuffer copy(const std::string_view &str);
+		///Creates buffer for data owned by an other object
+		/**
+		 * @param data content of the buffer
+		 * @param owner object which keeps the data valid. It is destroyed along with the buffer
+		 * @return buffer
+		 *
+		 * @code
+		 * std::shared_ptr<char[]> mem = ...;
+		 * PSharedBuffer buff = SharedBuffer::create(std::string_view(mem.get(), size), mem);
+		 * @endcode
+		 */
+		template<typename Owner>
+		static PSharedBuffer create(const std::string_view &data, Owner &&owner);
+
+	protected:
+		SharedBuffer(const std::string_view &data):data(data) {}
+
+		std::string_view data;
+
+		template<typename Owner> class Owned;
+	};
+
+	template<typename Owner>
+	class SharedBuffer::Owned: public SharedBuffer {
+	public:
+		Owned(const std::string_view &data, Owner &&owner)
+			:SharedBuffer(data),owner(std::forward<Owner>(owner)) {}
+
+		std::decay_t<Owner> owner;
+	};
+
+	template<typename Owner>
+	inline PSharedBuffer SharedBuffer::create(const std::string_view &data, Owner &&owner) {
+		return new Owned<Owner>(data, std::forward<Owner>(owner));
+	}
+
+	///Source of the parser, which reads the shared buffer
+	/** The parser recognizes this source and creates strings which refer to the buffer
+	 *
+	 * @see Value::fromBuffer
+	 */
+	class SharedBufferSource {
+	public:
+		SharedBufferSource(const PSharedBuffer &buffer):buffer(buffer),data(buffer->getData()),pos(0) {}
+
+		int operator()() {
+			if (pos < data.size()) return static_cast<unsigned char>(data[pos++]);
+			else return -1;
+		}
+
+		///Retrieves the buffer
+		const PSharedBuffer &getBuffer() const {return buffer;}
+		///Retrieves unread part of the buffer
+		std::string_view getRemain() const {return data.substr(pos);}
+		///Skips characters
+		void skip(std::size_t count) {pos += count;}
+
+	protected:
+		PSharedBuffer buffer;
+		std::string_view data;
+		std::size_t pos;
+	};
+
+}
@@ -0,0 +1,100 @@
+#include <new>
+#include "smallObjectValue.h"
+#include "allocator.h"
+
+namespace json {
+
+	static_assert(sizeof(SmallObjectValue) % alignof(ObjectEntry) == 0, "Members must be aligned");
+
+	RefCntPtr<const IValue> SmallObjectValue::itemAtIndex(std::size_t index) const {
+		if (index < curSize) return proxies.get(index, capacity, [&]{return entries()[index].toItem();});
+		return getUndefined();
+	}
+
+	RefCntPtr<const IValue> SmallObjectValue::member(const std::string_view &name) const {
+		const ObjectEntry *e = findEntry(name);
+		if (e == nullptr) return getUndefined();
+		else return proxies.get(e - entries(), capacity, [&]{return e->toItem();});
+	}
+
+	const IValue *SmallObjectValue::borrowAtIndex(std::size_t index) const {
+		if (index < curSize) return entries()[index].value;
+		return getUndefined();
+	}
+
+	const IValue *SmallObjectValue::borrowMember(const std::string_view &name) const {
+		const ObjectEntry *e = findEntry(name);
+		if (e == nullptr) return getUndefined();
+		else return e->value;
+	}
+
+	StringView SmallObjectValue::memberNameAtIndex(std::size_t index) const {
+		if (index < curSize) return entries()[index].getKey();
+		return StringView();
+	}
+
+	const IValue *SmallObjectValue::memberKeyAtIndex(std::size_t index) const {
+		if (index < curSize) return entries()[index].key;
+		return nullptr;
+	}
+
+	bool SmallObjectValue::forEachRef(const IEnumFn &fn) const {
+		const ObjectEntry *e = entries();
+		for (unsigned int i = 0; i < curSize; i++) {
+			if (!fn(e[i].key) || !fn(e[i].value)) return false;
+		}
+		return true;
+	}
+
+	const ObjectEntry *SmallObjectValue::findEntry(const std::string_view &name) const {
+		const ObjectEntry *e = entries();
+		for (unsigned int i = 0; i < curSize; i++) {
+			StringView k = e[i].getKey();
+			if (k.size() == name.size() && name.compare(k) == 0) {
+				return e+i;
+			}
+		}
+		return nullptr;
+	}
+
+	RefCntPtr<SmallObjectValue> SmallObjectValue::create(std::size_t capacity) {
+		return new(capacity) SmallObjectValue(capacity);
+	}
+
+	bool SmallObjectValue::push_back(ObjectEntry &&entry) {
+		if (curSize >= capacity) return false;
+		new(entries()+curSize) ObjectEntry(std::move(entry));
+		curSize++;
+		return true;
+	}
+
+	bool SmallObjectValue::push_back(const ObjectEntry &entry) {
+		if (curSize >= capacity) return false;
+		new(entries()+curSize) ObjectEntry(entry);
+		curSize++;
+		return true;
+	}
+
+	void SmallObjectValue::sort() {
+		proxies.clear();
+		std::size_t cnt = ObjectEntry::sort(entries(), curSize);
+		while (curSize > cnt) entries()[--curSize].~ObjectEntry();
+	}
+
+	SmallObjectValue::~SmallObjectValue() {
+		while (curSize) entries()[--curSize].~ObjectEntry();
+	}
+
+	void *SmallObjectValue::operator new(std::size_t sz, const std::size_t &capacity) {
+		return Allocator::getInstance()->alloc(sz + capacity * sizeof(ObjectEntry));
+	}
+
+	void SmallObjectValue::operator delete(void *ptr, const std::size_t &) {
+		Allocator::getInstance()->dealloc(ptr);
+	}
+
+	void SmallObjectValue::operator delete(void *ptr, std::size_t) {
+		Allocator::getInstance()->dealloc(ptr);
+	}
+
+}
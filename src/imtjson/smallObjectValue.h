@@ -0,0 +1,68 @@
+#pragma once
+
+#include "basicValues.h"
+#include "objectValue.h"
+
+namespace json {
+
+	///Compact object with few members
+	/** Members are stored in one allocation along with the object. Lookup is performed by
+	 * the linear scan, which is faster than the binary search for few members.
+	 * The parser and the Object create small objects automatically
+	 */
+	class SmallObjectValue : public AbstractObjectValue {
+	public:
+
+		///Maximum count of members of the small object
+		static const std::size_t maxMembers = 8;
+
+		virtual std::size_t size() const override {return curSize;}
+		virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const override;
+		virtual RefCntPtr<const IValue> member(const std::string_view &name) const override;
+		virtual const IValue *borrowAtIndex(std::size_t index) const override;
+		virtual const IValue *borrowMember(const std::string_view &name) const override;
+		virtual StringView memberNameAtIndex(std::size_t index) const override;
+		virtual const IValue *memberKeyAtIndex(std::size_t index) const override;
+		virtual bool forEachRef(const IEnumFn &fn) const override;
+		virtual std::size_t memorySize() const override {return sizeof(SmallObjectValue) + capacity * sizeof(ObjectEntry) + proxies.memorySize();}
+
+		virtual bool getBool() const override {return true;}
+
+		///Creates empty object
+		/**
+		 * @param capacity count of members (maximum is not checked)
+		 * @return empty object. Push members by the function push_back(), then call sort()
+		 */
+		static RefCntPtr<SmallObjectValue> create(std::size_t capacity);
+
+		///Pushes the member
+		bool push_back(ObjectEntry &&entry);
+		///Pushes the member
+		bool push_back(const ObjectEntry &entry);
+		///Sorts the members and removes duplicated keys
+		void sort();
+
+		const ObjectEntry *findEntry(const std::string_view &name) const;
+		const ObjectEntry &operator[](std::size_t index) const {return entries()[index];}
+
+		~SmallObjectValue();
+
+		void *operator new(std::size_t sz, const std::size_t &capacity);
+		void operator delete(void *ptr, const std::size_t &capacity);
+		void operator delete(void *ptr, std::size_t sz);
+
+	protected:
+		SmallObjectValue(std::size_t capacity):capacity(static_cast<unsigned int>(capacity)),curSize(0) {}
+
+		unsigned int capacity;
+		unsigned int curSize;
+		///Members returned with the key
+		ProxyCache proxies;
+
+		///members are stored after the object
+		ObjectEntry *entries() const {
+			return reinterpret_cast<ObjectEntry *>(const_cast<SmallObjectValue *>(this)+1);
+		}
+	};
+
+}
@@ -9,6 +9,7 @@
 #define SRC_IMTJSON_STREAMS_H_
 
 #include <iostream>
+#include <string_view>
 
 
 #pragma once
@@ -43,6 +44,7 @@ inline StreamFromStdStream fromStream(std::istream &stream) {
 }
 
 ///A helper class which provides reading from a string
+/** The parser reads the string directly, see IsContiguousSource */
 template<typename Src>
 class StreamFromStringT {
 public:
@@ -51,6 +53,10 @@ public:
 		if (pos < string.size()) return (unsigned char)string[pos++];
 		else return eof;
 	}
+	///Retrieves unread part of the string
+	Src getRemain() const {return string.substr(pos);}
+	///Skips characters
+	void skip(std::size_t count) const {pos += count;}
 private:
 	Src string;
 	mutable std::size_t pos;
@@ -78,6 +84,9 @@ public:
 	void operator()(char c) const {
 		stream.put(c);
 	}
+	void write(const std::string_view &text) const {
+		stream.write(text.data(), text.size());
+	}
 private:
 	std::ostream &stream;
 };
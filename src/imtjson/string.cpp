@@ -122,6 +122,9 @@ StringView String::str() const {
 }
 
 const char* String::c_str() const {
+	//strings which refer to a buffer are not terminated by zero
+	const StringRefValue *ref = dynamic_cast<const StringRefValue *>(impl->unproxy());
+	if (ref) return ref->c_str();
 	return impl->getString().data();
 }
 
@@ -172,6 +175,8 @@ public:
 		return parent->getString().substr(pos,length);
 	}
 	virtual bool getBool() const override {return true;}
+	virtual bool forEachRef(const IEnumFn &fn) const override {return fn(parent);}
+	virtual std::size_t memorySize() const override {return sizeof(SubStrString);}
 
 
 	PValue parent;
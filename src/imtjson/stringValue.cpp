@@ -6,6 +6,10 @@
  */
 
 #include <cstring>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
 
 #include "stringValue.h"
 
@@ -28,6 +32,11 @@ StringValue::StringValue(BinaryEncoding enc, const std::string_view& str):sz(str
 	if (std::string_view(trg,magic.size()) != magic) throw std::runtime_error("StringView must be allocated by special new operator");
 	std::memcpy(trg, str.data(), str.size());
 	trg[str.size()] = 0;
+	if (enc == nullptr) plain = checkPlain(str);
+}
+
+std::size_t StringValue::memorySize() const {
+	return sizeof(StringValue) - sizeof(charbuff) + std::max(sz+1, magic.size());
 }
 
 StringView StringValue::getString() const {
@@ -74,15 +83,15 @@ ULongInt AbstractStringValue::getUIntLong() const {
 void* StringValue::operator new(std::size_t sz, const std::size_t &strsz) {
 	std::size_t objsz = sz - sizeof(StringValue::charbuff);
 	std::size_t needsz = objsz + std::max(strsz+1, magic.size());
-	return putMagic(Value::allocator->alloc(needsz));
+	return putMagic(Allocator::getInstance()->alloc(needsz));
 }
 
 void StringValue::operator delete(void* ptr, const std::size_t &) {
-	Value::allocator->dealloc(ptr);
+	Allocator::getInstance()->dealloc(ptr);
 }
 
 void StringValue::operator delete(void* ptr, std::size_t ) {
-	Value::allocator->dealloc(ptr);
+	Allocator::getInstance()->dealloc(ptr);
 }
 
 double AbstractStringValue::getNumber() const {
@@ -98,6 +107,23 @@ PValue StringValue::create(const std::string_view& str) {
 	else return new(str.size()) StringValue(nullptr,str);
 }
 
+StringRefValue::~StringRefValue() {
+	delete [] cstr.load(std::memory_order_relaxed);
+}
+
+const char *StringRefValue::c_str() const {
+	char *s = cstr.load(std::memory_order_acquire);
+	if (s == nullptr) {
+		char *n = new char[str.size()+1];
+		std::memcpy(n, str.data(), str.size());
+		n[str.size()] = 0;
+		//other thread could create the copy in the meantime
+		if (cstr.compare_exchange_strong(s, n, std::memory_order_acq_rel)) s = n;
+		else delete [] n;
+	}
+	return s;
+}
+
 void StringValue::stringOverflow() {
 	std::cerr << "String buffer overflow, aborting" << std::endl << std::flush;
 	abort();
@@ -122,7 +148,7 @@ BinaryEncoding StringValue::getEncoding(const IValue* v) {
 template<typename T> struct NumbParser;
 template<> struct NumbParser<double> {
 	static double parse(const char *v) {
-		return strtod(v,nullptr);
+		return ParserHelper::parseDouble(v);
 	}
 	static const ValueTypeFlags flags = preciseNumber;
 };
@@ -243,7 +269,7 @@ PreciseNumberValue<T>::~PreciseNumberValue() {
 
 template<typename T>
 void PreciseNumberValue<T>::operator delete(void* ptr,	std::size_t ) {
-	Value::allocator->dealloc(ptr);
+	Allocator::getInstance()->dealloc(ptr);
 }
 
 template<typename T>
@@ -263,13 +289,13 @@ template<typename T>
 void* PreciseNumberValue<T>::operator new(std::size_t sz,	const std::size_t& strsz) {
 	std::size_t objsz = sz - sizeof(PreciseNumberValue<T>::charbuff);
 	std::size_t needsz = objsz + strsz+1;
-	return Value::allocator->alloc(needsz);
+	return Allocator::getInstance()->alloc(needsz);
 }
 
 
 template<typename T>
 void PreciseNumberValue<T>::operator delete(void* ptr, const std::size_t& ) {
-	Value::allocator->dealloc(ptr);
+	Allocator::getInstance()->dealloc(ptr);
 }
 
 template class PreciseNumberValue<double>;
@@ -310,7 +336,69 @@ Value ParserHelper::numberFromStringRaw(std::string_view str, bool force_double)
 	}
 }
 
-
-
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+///Converts 8 digits at once (SWAR)
+static std::uint32_t parseEightDigits(const char *p) {
+	std::uint64_t v;
+	std::memcpy(&v, p, 8);
+	v -= 0x3030303030303030ULL;
+	//combine pairs of digits, then pairs of pairs...
+	v = (v * 10) + (v >> 8);
+	v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+			+ (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+	return static_cast<std::uint32_t>(v);
+}
+#endif
+
+bool ParserHelper::parseUnsigned(std::string_view str, UInt &res) {
+	const UInt maxVal = static_cast<UInt>(-1);
+	const char *p = str.data();
+	const char *end = p + str.size();
+	UInt r = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	while (end - p >= 8) {
+		UInt v = parseEightDigits(p);
+		if (r > (maxVal - v) / 100000000U) return false;
+		r = r * 100000000U + v;
+		p += 8;
+	}
+#endif
+	while (p < end) {
+		UInt v = *p - '0';
+		if (r > (maxVal - v) / 10) return false;
+		r = r * 10 + v;
+		++p;
+	}
+	res = r;
+	return true;
+}
+
+double ParserHelper::parseDouble(std::string_view str) {
+	//leading '+' is not accepted by the conversion
+	if (!str.empty() && str[0] == '+') str = str.substr(1);
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+	double res;
+	auto r = std::from_chars(str.data(), str.data()+str.size(), res);
+	if (r.ec == std::errc()) return res;
+#endif
+	//out of range numbers are converted to infinity or zero by strtod
+	return std::strtod(std::string(str).c_str(), nullptr);
+}
+
+Value ParserHelper::numberFromText(std::string_view str, bool isFloat) {
+	if (!isFloat) {
+		bool neg = str[0] == '-';
+		std::string_view digits = str.substr(str[0] == '-' || str[0] == '+'?1:0);
+		UInt n;
+		if (parseUnsigned(digits, n)) {
+			if (!neg) return Value(n);
+			//tests, whether highest bit of unsigned integer is set
+			//if so, converting to signed triggers overflow
+			if (n & (UInt(1) << (sizeof(n) * 8 - 1))) return Value(-static_cast<double>(n));
+			return Value(-static_cast<Int>(n));
+		}
+	}
+	return Value(parseDouble(str));
+}
 
 }
@@ -10,8 +10,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstring>
 #include "basicValues.h"
 #include "binary.h"
+#include "sharedBuffer.h"
 
 namespace json {
 class StringValue: public AbstractStringValue {
@@ -21,7 +24,8 @@ public:
 
 	virtual StringView getString() const override;
 	virtual bool getBool() const override {return true;}
-	virtual ValueTypeFlags flags() const override {return encoding != 0?binaryString:0;}
+	virtual ValueTypeFlags flags() const override {return encoding != 0?binaryString:plain;}
+	virtual std::size_t memorySize() const override;
 
 	void *operator new(std::size_t sz, const std::size_t &strsz );
 	void operator delete(void *ptr, const std::size_t &sz);
@@ -38,6 +42,7 @@ protected:
 	StringValue(const StringValue &) = delete;
 	std::size_t sz;
 	BinaryEncoding encoding;
+	ValueTypeFlags plain = 0;
 	char charbuff[100]; ///< the string can be larger than 100 bytes - this is for preview in the debugger
 
 	static void *putMagic(void *obj);
@@ -55,6 +60,7 @@ inline StringValue::StringValue(BinaryEncoding encoding, std::size_t strSz, cons
 	if (wrsz > strSz || charbuff[strSz] != 0) stringOverflow();
 	charbuff[wrsz] = 0;
 	sz = wrsz;
+	if (encoding == nullptr) plain = checkPlain(std::string_view(charbuff, sz));
 }
 
 
@@ -70,6 +76,9 @@ public:
 	virtual bool getBool() const override;
 	virtual ValueTypeFlags flags() const override;
 	virtual StringView getString() const override;
+	virtual std::size_t memorySize() const override {
+		return sizeof(PreciseNumberValue) - sizeof(charbuff) + std::strlen(charbuff) + 1;
+	}
 
 	///Constructs PValue
 	/** @note constructor doesn't check content - you need to handle it before */
@@ -95,6 +104,39 @@ protected:
 	char charbuff[100];
 };
 
+///String which refers to a part of a shared buffer
+/** The string doesn't copy the characters. It holds a reference to the buffer
+ * instead. It is created by Value::fromBuffer() for long strings without escape sequences
+ */
+class StringRefValue: public AbstractStringValue {
+public:
+	///Shorter strings are copied
+	static const std::size_t minSize = 32;
+
+	StringRefValue(const PSharedBuffer &buffer, const std::string_view &str)
+		:buffer(buffer),str(str),plain(checkPlain(str)) {}
+	~StringRefValue();
+
+	virtual StringView getString() const override {return str;}
+	virtual bool getBool() const override {return true;}
+	virtual ValueTypeFlags flags() const override {return plain;}
+	///The shared buffer is not included
+	virtual std::size_t memorySize() const override {
+		return sizeof(StringRefValue) + (cstr.load(std::memory_order_relaxed)?str.size()+1:0);
+	}
+
+	///Retrieves string terminated by zero
+	/** The characters in the buffer are not terminated, so the function
+	 * creates a copy on the first call */
+	const char *c_str() const;
+
+protected:
+	PSharedBuffer buffer;
+	std::string_view str;
+	ValueTypeFlags plain;
+	mutable std::atomic<char *> cstr = nullptr;
+};
+
 typedef PreciseNumberValue<double> PreciseNumberValueDouble;
 typedef PreciseNumberValue<UInt> PreciseNumberValueUnsigned;
 typedef PreciseNumberValue<Int> PreciseNumberValueSigned;
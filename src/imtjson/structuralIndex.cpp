@@ -0,0 +1,203 @@
+#include <cstring>
+#include "structuralIndex.h"
+
+#if (defined(__x86_64__) || defined(__amd64__)) && defined(__GNUC__)
+#define IMTJSON_STRUCTURAL_X86
+#include <immintrin.h>
+#endif
+
+namespace json {
+
+	///Classes of the characters of the block, every bit represents one character
+	struct BlockMasks {
+		std::uint64_t quote;
+		std::uint64_t backslash;
+		///brackets, braces, colons and commas
+		std::uint64_t op;
+		std::uint64_t ws;
+	};
+
+	///State carried between the blocks
+	struct BlockState {
+		///first character of the block is escaped
+		std::uint64_t prevEscaped = 0;
+		///all ones, if the previous block ended in a string
+		std::uint64_t prevInString = 0;
+		///last character of the previous block was part of a number or a keyword
+		std::uint64_t prevScalar = 0;
+	};
+
+	static const std::size_t blockSize = 64;
+
+	static void classifyScalar(const char *block, BlockMasks &m) {
+		m = BlockMasks{0,0,0,0};
+		for (std::size_t i = 0; i < blockSize; i++) {
+			std::uint64_t bit = std::uint64_t(1) << i;
+			switch (block[i]) {
+				case '"': m.quote |= bit; break;
+				case '\\': m.backslash |= bit; break;
+				case '{':
+				case '}':
+				case '[':
+				case ']':
+				case ':':
+				case ',': m.op |= bit; break;
+				case ' ':
+				case '\t':
+				case '\n':
+				case '\v':
+				case '\f':
+				case '\r': m.ws |= bit; break;
+				default: break;
+			}
+		}
+	}
+
+#ifdef IMTJSON_STRUCTURAL_X86
+
+	static void classifySSE2(const char *block, BlockMasks &m) {
+		m = BlockMasks{0,0,0,0};
+		for (std::size_t i = 0; i < blockSize; i += 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+			auto eq = [&](char c) {return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));};
+			auto bits = [&](__m128i x) {return static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(x))) << i;};
+			__m128i op = _mm_or_si128(_mm_or_si128(_mm_or_si128(eq('{'), eq('}')), _mm_or_si128(eq('['), eq(']'))),
+					_mm_or_si128(eq(':'), eq(',')));
+			//characters 9...13 give zero after the subtraction
+			__m128i ctl = _mm_subs_epu8(_mm_sub_epi8(v, _mm_set1_epi8(9)), _mm_set1_epi8(4));
+			__m128i ws = _mm_or_si128(eq(' '), _mm_cmpeq_epi8(ctl, _mm_setzero_si128()));
+			m.quote |= bits(eq('"'));
+			m.backslash |= bits(eq('\\'));
+			m.op |= bits(op);
+			m.ws |= bits(ws);
+		}
+	}
+
+	__attribute__((target("avx2")))
+	static inline __m256i eqAVX2(__m256i v, char c) {
+		return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+	}
+
+	__attribute__((target("avx2")))
+	static inline std::uint64_t maskAVX2(__m256i x) {
+		return static_cast<std::uint32_t>(_mm256_movemask_epi8(x));
+	}
+
+	__attribute__((target("avx2")))
+	static void classifyAVX2(const char *block, BlockMasks &m) {
+		m = BlockMasks{0,0,0,0};
+		for (std::size_t i = 0; i < blockSize; i += 32) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+			__m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(eqAVX2(v, '{'), eqAVX2(v, '}')),
+					_mm256_or_si256(eqAVX2(v, '['), eqAVX2(v, ']'))), _mm256_or_si256(eqAVX2(v, ':'), eqAVX2(v, ',')));
+			//characters 9...13 give zero after the subtraction
+			__m256i ctl = _mm256_subs_epu8(_mm256_sub_epi8(v, _mm256_set1_epi8(9)), _mm256_set1_epi8(4));
+			__m256i ws = _mm256_or_si256(eqAVX2(v, ' '), _mm256_cmpeq_epi8(ctl, _mm256_setzero_si256()));
+			m.quote |= maskAVX2(eqAVX2(v, '"')) << i;
+			m.backslash |= maskAVX2(eqAVX2(v, '\\')) << i;
+			m.op |= maskAVX2(op) << i;
+			m.ws |= maskAVX2(ws) << i;
+		}
+	}
+
+#endif
+
+	///Finds characters escaped by odd count of backslashes
+	static std::uint64_t findEscaped(std::uint64_t backslash, std::uint64_t &prevEscaped) {
+		backslash &= ~prevEscaped;
+		std::uint64_t followsEscape = (backslash << 1) | prevEscaped;
+		const std::uint64_t evenBits = 0x5555555555555555ULL;
+		std::uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+		std::uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+		//carry means, that the sequence of backslashes continues in the next block
+		prevEscaped = sequencesStartingOnEvenBits < oddSequenceStarts?1:0;
+		std::uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+		return (evenBits ^ invertMask) & followsEscape;
+	}
+
+	///Every bit is xor of all preceding bits (including the bit)
+	static std::uint64_t prefixXor(std::uint64_t x) {
+		x ^= x << 1;
+		x ^= x << 2;
+		x ^= x << 4;
+		x ^= x << 8;
+		x ^= x << 16;
+		x ^= x << 32;
+		return x;
+	}
+
+	static unsigned int lowestBit(std::uint64_t x) {
+#ifdef __GNUC__
+		return __builtin_ctzll(x);
+#else
+		unsigned int r = 0;
+		while ((x & 1) == 0) {x >>= 1; r++;}
+		return r;
+#endif
+	}
+
+	static std::uint64_t findStructurals(const BlockMasks &m, BlockState &st) {
+		std::uint64_t escaped = findEscaped(m.backslash, st.prevEscaped);
+		std::uint64_t quote = m.quote & ~escaped;
+		//opening quote is inside of the string, closing quote is outside
+		std::uint64_t inString = prefixXor(quote) ^ st.prevInString;
+		st.prevInString = static_cast<std::uint64_t>(static_cast<std::int64_t>(inString) >> 63);
+		std::uint64_t scalar = ~(m.op | m.ws | quote | inString);
+		std::uint64_t scalarStart = scalar & ~((scalar << 1) | st.prevScalar);
+		st.prevScalar = scalar >> 63;
+		return (m.op & ~inString) | (quote & inString) | scalarStart;
+	}
+
+	template<typename Classify>
+	static void buildIndex(const std::string_view &text, std::vector<std::uint32_t> &offsets, Classify &&classify) {
+		BlockState st;
+		BlockMasks m;
+		std::size_t cnt = 0;
+		offsets.resize(text.size() / 8 + blockSize);
+		auto store = [&](std::size_t base, std::uint64_t s) {
+			if (cnt + blockSize > offsets.size()) offsets.resize(offsets.size() * 2);
+			std::uint32_t *out = offsets.data() + cnt;
+			while (s) {
+				*out++ = static_cast<std::uint32_t>(base + lowestBit(s));
+				s &= s - 1;
+			}
+			cnt = out - offsets.data();
+		};
+		std::size_t pos = 0;
+		for (; pos + blockSize <= text.size(); pos += blockSize) {
+			classify(text.data() + pos, m);
+			store(pos, findStructurals(m, st));
+		}
+		if (pos < text.size()) {
+			//last block is padded by spaces
+			char block[blockSize];
+			std::memset(block, ' ', blockSize);
+			std::memcpy(block, text.data() + pos, text.size() - pos);
+			classify(block, m);
+			store(pos, findStructurals(m, st));
+		}
+		offsets.resize(cnt);
+	}
+
+	StructuralIndex::Impl StructuralIndex::getBestImpl() {
+#ifdef IMTJSON_STRUCTURAL_X86
+		static Impl impl = __builtin_cpu_supports("avx2")?avx2:sse2;
+		return impl;
+#else
+		return scalar;
+#endif
+	}
+
+	void StructuralIndex::build(const std::string_view &text, Impl impl) {
+		Impl b = getBestImpl();
+		if (impl == best || impl > b) impl = b;
+		switch (impl) {
+#ifdef IMTJSON_STRUCTURAL_X86
+			case avx2: buildIndex(text, offsets, classifyAVX2); break;
+			case sse2: buildIndex(text, offsets, classifySSE2); break;
+#endif
+			default: buildIndex(text, offsets, classifyScalar); break;
+		}
+	}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+	///Index of the structural characters of a JSON text
+	/** The index is the first stage of the IndexedParser. It contains offsets of the
+	 * characters, where the tokens start:
+	 *
+	 * - brackets, braces, colons and commas outside of the strings
+	 * - opening quotes of the strings
+	 * - first characters of numbers and keywords (true, false, null), or of any other
+	 *   text outside of the strings, which follows a whitespace or a structural character
+	 *
+	 * The text is classified in blocks of 64 bytes. Every class of characters is represented as a 64-bit
+	 * mask, so the strings and the escape sequences are resolved by few bit operations
+	 * per block. The classification uses AVX2 or SSE2 instructions, if they are supported by the CPU,
+	 * otherwise a scalar code is used. The implementation is chosen at runtime.
+	 *
+	 * @note The index doesn't validate the text. Invalid texts are detected by the second stage.
+	 */
+	class StructuralIndex {
+	public:
+
+		///Implementation of the classification
+		enum Impl {
+			///chosen by the CPU (default)
+			best,
+			///portable code
+			scalar,
+			///SSE2 instructions (x86-64 only)
+			sse2,
+			///AVX2 instructions (x86-64 only)
+			avx2
+		};
+
+		///Largest text which can be indexed (offsets are 32-bit)
+		static const std::size_t maxSize = 0xFFFFFFFFU;
+
+		///Builds the index
+		/**
+		 * @param text text to index. It must not be longer than maxSize
+		 * @param impl implementation. If the implementation is not supported by the CPU,
+		 *   the best supported implementation is used
+		 */
+		void build(const std::string_view &text, Impl impl = best);
+
+		///Retrieves implementation used for the value best
+		static Impl getBestImpl();
+
+		///Retrieves count of indexed characters
+		std::size_t size() const {return offsets.size();}
+		///Retrieves offset of the indexed character
+		std::uint32_t operator[](std::size_t pos) const {return offsets[pos];}
+		///Retrieves all offsets
+		const std::vector<std::uint32_t> &getOffsets() const {return offsets;}
+
+	protected:
+		std::vector<std::uint32_t> offsets;
+	};
+
+}
@@ -1,7 +1,10 @@
 #include <cstring>
+#include <cstdio>
+#include <charconv>
 #include "value.h"
 
 #include <numeric>
+#include <unordered_set>
 
 #include "basicValues.h"
 #include "arrayValue.h"
@@ -12,15 +15,59 @@
 #include "serializer.h"
 #include "binary.h"
 #include "stringValue.h"
-#include "fnv.h"
 #include "binjson.tcc"
 #include "path.h"
 #include "operations.h"
+#include "arena.h"
+#include "chunkMap.h"
+#include "pool.h"
+#include "keyTable.h"
+#include "streams.h"
 
 namespace json {
 
 	KeyStart key;
 
+	thread_local unsigned int LocalTreeScope::level = 0;
+
+	///Publishes the value and all its descendants
+	/**
+	 * @param v value to publish
+	 * @param visited shared nodes already published. A node referenced once can be reached
+	 * only through one path, so only the nodes with more references are recorded. This keeps
+	 * the walk linear for the trees with shared subtrees (see Value::dedup())
+	 */
+	static void publishValue(const IValue *v, std::unordered_set<const IValue *> &visited) {
+		if (v->isImmortal()) return;
+		if (v->use_count() > 1 && !visited.insert(v).second) return;
+		v->publish();
+		v->forEachRef(EnumFn([&](const IValue *x){
+			publishValue(x, visited);
+			return true;
+		}));
+	}
+
+	const Value &Value::publish() const {
+		std::unordered_set<const IValue *> visited;
+		publishValue(v, visited);
+		return *this;
+	}
+
+	static void freezeValue(const IValue *v) {
+		if (v->isImmortal()) return;
+		v->publish();
+		v->setImmortal();
+		v->forEachRef(EnumFn([](const IValue *x){
+			freezeValue(x);
+			return true;
+		}));
+	}
+
+	const Value &Value::freeze() const {
+		freezeValue(v);
+		return *this;
+	}
+
 
 	const IValue *createByType(ValueType vtype) {
 		switch (vtype) {
@@ -82,19 +129,18 @@ namespace json {
 
 	Value Value::fromString(const std::string_view& string)
 	{
-		std::size_t pos = 0;
-		return parse([&pos,&string]() -> char {
-			if (pos == string.size())
-				return -1;
-			else
-				return string[pos++];
-		});
+		return parse(StreamFromString(string));
 	}
 	Value Value::fromString(const BinaryView& string)
 	{
 		return fromString(map_bin2str(string));
 	}
 
+	Value Value::fromBuffer(const PSharedBuffer &buffer)
+	{
+		return parse(SharedBufferSource(buffer));
+	}
+
 	Value Value::fromStream(std::istream & input)
 	{
 		return parse([&]() {
@@ -109,41 +155,44 @@ namespace json {
 		});
 	}
 
+	///Serializer's target which writes the output to a FILE
+	class FileTarget {
+	public:
+		FileTarget(FILE *f):f(f) {}
+		void operator()(char c) {fputc(c, f);}
+		void write(const std::string_view &text) {fwrite(text.data(), 1, text.size(), f);}
+	protected:
+		FILE *f;
+	};
+
 	String Value::stringify() const
 	{
 		std::string buff;
-		serialize([&](char c) {
-			buff.push_back(c);
-		});
+		serialize(StringifyTarget(buff));
 		return String(buff);
 	}
 
 	String Value::stringify(UnicodeFormat format) const
 	{
 		std::string buff;
-		serialize(format,[&](char c) {
-			buff.push_back(c);
-		});
+		serialize(format,StringifyTarget(buff));
 		return String(buff);
 	}
 
 	void Value::toStream(std::ostream & output) const
 	{
-		serialize([&](char c) {
-			output.put(c);
-		});
+		serialize(StreamToStdStream(output));
 	}
 
 	void Value::toStream(UnicodeFormat format, std::ostream & output) const
 	{
-		serialize(format, [&](char c) {
-			output.put(c);
-		});
+		serialize(format, StreamToStdStream(output));
 	}
 
 	template<typename T>
 	PValue allocUnsigned(T x) {
 		if (x == (T)0) return AbstractNumberValue::getZero();
+		if (x <= (T)AbstractNumberValue::smallIntMax) return AbstractNumberValue::getSmallUInt(UInt(x));
 		if (sizeof(T) <= sizeof(uintptr_t)) return new UnsignedIntegerValue(uintptr_t(x));
 		else if (sizeof(T) <= sizeof(ULongInt)) return new UnsignedLongValue(ULongInt(x));
 		else return new NumberValue((double)x);
@@ -152,6 +201,8 @@ namespace json {
 	template<typename T>
 	PValue allocSigned(T x) {
 		if (x == (T)0) return AbstractNumberValue::getZero();
+		if (x >= (T)AbstractNumberValue::smallIntMin && x <= (T)AbstractNumberValue::smallIntMax)
+			return AbstractNumberValue::getSmallInt(Int(x));
 		if (sizeof(T) <= sizeof(intptr_t)) return new IntegerValue(intptr_t(x));
 		else if (sizeof(T) <= sizeof(LongInt)) return new LongValue(LongInt(x));
 		else return new NumberValue((double)x);
@@ -183,16 +234,12 @@ namespace json {
 
 	void Value::toFile(FILE * f) const
 	{
-		serialize([&](char c) {
-			fputc(c, f);
-		});
+		serialize(FileTarget(f));
 	}
 
 	void Value::toFile(UnicodeFormat format, FILE * f) const
 	{
-		serialize(format, [&](char c) {
-			fputc(c, f);
-		});
+		serialize(format, FileTarget(f));
 	}
 
 	class SubArray : public AbstractArrayValue {
@@ -215,8 +262,14 @@ namespace json {
 		virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const override {
 			return parent->itemAtIndex(start + index);
 		}
+		virtual const IValue *borrowAtIndex(std::size_t index) const override {
+			if (index < len) return parent->borrowAtIndex(start + index);
+			else return getUndefined();
+		}
 
 		virtual bool getBool() const override { return true; }
+		virtual bool forEachRef(const IEnumFn &fn) const override {return fn(parent);}
+		virtual std::size_t memorySize() const override {return sizeof(SubArray);}
 	protected:
 		PValue parent;
 		std::size_t start;
@@ -310,6 +363,73 @@ namespace json {
 	uintptr_t maxPrecisionDigits = 9;
 	UnicodeFormat defaultUnicodeFormat = emitEscaped;
 	bool enableParsePreciseNumbers = false;
+	bool enableParseShapes = true;
+	bool enableParsePackedArrays = false;
+
+	std::size_t formatShortestDouble(double value, char *buff) {
+		//shortest digits in the scientific format: d[.ddd]e(+|-)dd
+		char sci[32];
+#ifdef __cpp_lib_to_chars
+		const char *sciEnd = std::to_chars(sci, sci+sizeof(sci), value, std::chars_format::scientific).ptr;
+#else
+		int l = 0;
+		for (int p = 0; p < 17; p++) {
+			l = std::snprintf(sci, sizeof(sci), "%.*e", p, value);
+			if (std::strtod(sci, nullptr) == value) break;
+		}
+		const char *sciEnd = sci+l;
+#endif
+		char digits[20];
+		int n = 0;
+		const char *c = sci;
+		for (; c != sciEnd && *c != 'e'; ++c) if (*c != '.') digits[n++] = *c;
+		while (n > 1 && digits[n-1] == '0') --n;
+		//the text is not terminated, so the exponent is parsed here
+		int exp = 0;
+		bool negExp = false;
+		if (c != sciEnd) {
+			for (++c; c != sciEnd; ++c) {
+				if (*c == '-') negExp = true;
+				else if (*c != '+') exp = exp * 10 + (*c - '0');
+			}
+		}
+		if (negExp) exp = -exp;
+
+		char *out = buff;
+		if (exp > -3 && exp < 8) {
+			if (exp < 0) {
+				*out++ = '0';
+				*out++ = '.';
+				for (int i = -1; i > exp; --i) *out++ = '0';
+				for (int i = 0; i < n; i++) *out++ = digits[i];
+			} else {
+				int i = 0;
+				for (; i <= exp; i++) *out++ = i < n?digits[i]:'0';
+				if (i < n) {
+					*out++ = '.';
+					for (; i < n; i++) *out++ = digits[i];
+				}
+			}
+		} else {
+			*out++ = digits[0];
+			if (n > 1) {
+				*out++ = '.';
+				for (int i = 1; i < n; i++) *out++ = digits[i];
+			}
+			*out++ = 'e';
+			if (exp < 0) {
+				*out++ = '-';
+				exp = -exp;
+			} else {
+				*out++ = '+';
+			}
+			char e[8];
+			int el = 0;
+			do {e[el++] = '0' + exp % 10; exp /= 10;} while (exp);
+			while (el) *out++ = e[--el];
+		}
+		return out - buff;
+	}
 
 	///const double maxMantisaMult = pow(10.0, floor(log10(UInt(-1))));
 
@@ -349,23 +469,54 @@ namespace json {
 
 
 
-	static Allocator defaultAllocator = {
+	static Allocator heapAllocator = {
 		&::operator new,
 		&::operator delete
 	};
 
+	static Allocator poolAllocator = {
+		&PoolAllocator::alloc,
+		&PoolAllocator::dealloc
+	};
+
+
+	const Allocator * Value::allocator = &poolAllocator;
+
+	static void *dispatchAlloc(std::size_t sz) {
+		Arena *arena = Arena::current();
+		if (arena) return arena->alloc(sz);
+		else return Value::allocator->alloc(sz);
+	}
+
+	static void dispatchDealloc(void *ptr) {
+		ChunkHeader *chunk = ChunkMap::find(ptr);
+		if (chunk) chunk->release(chunk, ptr);
+		else Value::allocator->dealloc(ptr);
+	}
 
-	const Allocator * Value::allocator = &defaultAllocator;
+	///Allocator which routes requests to the active arena or to the Value::allocator
+	static Allocator dispatchAllocator = {
+		&dispatchAlloc,
+		&dispatchDealloc
+	};
 
 	void *AllocObject::operator new(std::size_t sz) {
-		return Value::allocator->alloc(sz);
+		return dispatchAlloc(sz);
 	}
 	void AllocObject::operator delete(void *ptr, std::size_t) {
-		return Value::allocator->dealloc(ptr);
+		return dispatchDealloc(ptr);
 	}
 
 	const Allocator *Allocator::getInstance() {
-		return Value::allocator;
+		return &dispatchAllocator;
+	}
+
+	const Allocator *Allocator::getHeap() {
+		return &heapAllocator;
+	}
+
+	const Allocator *Allocator::getPool() {
+		return &poolAllocator;
 	}
 
 
@@ -829,42 +980,40 @@ namespace json {
 		int i = 0; for (const auto &x: fields) buffer[i++] = &x;
 		std::sort(buffer, buffer+fields.size(), [](const auto *a, const auto *b){return a->first < b->first;});
 		auto res = ObjectValue::create(fields.size()+size());
-		auto i1 = begin();
+		auto pushLeft = [&](std::size_t i) {
+			res->push_back(ObjectEntry::fromMember(v->unproxy(), i));
+		};
+		auto pushRight = [&](const std::pair<std::string_view, Value> *right) {
+			if (right->second.defined()) {
+				res->push_back(ObjectEntry(KeyTable::intern(right->first).getHandle(), right->second.getHandle()->unproxy()));
+			}
+		};
+		std::size_t i1 = 0;
+		std::size_t e1 = size();
 		auto i2 = buffer;
-		auto e1 = end();
 		auto e2 = buffer+fields.size();
 		while (i1 != e1 && i2 != e2) {
-			Value left = *i1;
+			ItemRef litem(v->unproxy(), i1);
+			StringView lkey = litem.getMemberName();
 			const auto *right = *i2;
-			if (left.getKey() < right->first) {
-				res->push_back(left.v);
+			if (lkey < right->first) {
+				pushLeft(i1);
 				i1++;
-			} else if (left.getKey() > right->first) {
-				if (right->second.defined()) {
-					auto pv = right->second.setKey(right->first).v;
-					res->push_back(std::move(pv));
-				}
+			} else if (lkey > right->first) {
+				pushRight(right);
 				i2++;
 			} else {
-				if (right->second.defined()) {
-					auto pv = right->second.setKey(right->first).v;
-					res->push_back(std::move(pv));
-				}
+				pushRight(right);
 				i1++;
 				i2++;
 			}
 		}
 		while (i1 != e1) {
-			Value left = *i1;
-			res->push_back(left.v);
+			pushLeft(i1);
 			i1++;
 		}
 		while (i2 != e2) {
-			const auto *right = *i2;
-			if (right->second.defined()) {
-				auto pv = right->second.setKey(right->first).v;
-				res->push_back(std::move(pv));
-			}
+			pushRight(*i2);
 			i2++;
 		}
 
@@ -965,10 +1114,7 @@ namespace json {
 
 namespace std {
 size_t hash<::json::Value>::operator()(const ::json::Value &v)const {
-	size_t ret = 0;
-	FNV1a<sizeof(ret)> fnvcalc(ret);
-	v.stripKey().serializeBinary(fnvcalc,0);
-	return ret;
+	return v.hash();
 }
 
 
@@ -12,14 +12,33 @@ namespace json {
 	class Path;
 	class PPath;
 	class ValueIterator;
+	class ValueView;
 	class String;
 	class Binary;
 	class ValueBuilder;
+	class PackedStringsView;
+	class SharedBuffer;
 	struct Allocator;
 	template<typename T> class ConvValueAs;
 	template<typename T> class ConvValueFrom;
 	template<typename Cmp> class Ordered;
 
+	///Memory occupied by a value, see Value::memoryUsage()
+	struct MemoryUsage {
+		///Count of types, used to size the arrays
+		static const std::size_t typeCount = undefined + 1;
+
+		///Bytes occupied by all reachable values. Shared values are counted once
+		std::size_t total = 0;
+		///Bytes which are not shared with other values. They are released with the value
+		std::size_t unique = 0;
+		///Count of reachable values
+		std::size_t count = 0;
+		///Total bytes by type (indexed by ValueType)
+		std::size_t byType[typeCount] = {};
+		///Unique bytes by type (indexed by ValueType)
+		std::size_t uniqueByType[typeCount] = {};
+	};
 
 	///Stores one JSON value
 	/** The instance of the class Value can store one value of any JSON type:
@@ -227,6 +246,57 @@ namespace json {
 		 */
 		static Value preciseNumber(const std::string_view &number);
 
+		///Creates array of numbers or strings packed in a contiguous memory
+		/** Packed array of numbers occupies 8 bytes per number. Numbers are converted to LongInt, ULongInt
+		 * or double depending on the type T. Strings (std::string, std::string_view) are
+		 * stored in a single buffer. The array acts as an ordinary array
+		 *
+		 * @param data pointer to items
+		 * @param count count of items
+		 * @return packed array
+		 *
+		 * @see getPacked, getPackedStrings
+		 */
+		template<typename T>
+		static Value packedArray(const T *data, std::size_t count);
+
+		///Retrieves numbers of packed array
+		/** Allows to process the numbers in a tight loop without materializing the items
+		 *
+		 * @tparam T type of numbers, it can be LongInt, ULongInt or double. It must match to the type
+		 * of the packed array (see flag packedNumbers and getPackedItemFlags())
+		 * @return range of numbers. If the value is not a packed array of given type, returns
+		 * the range (nullptr, nullptr)
+		 *
+		 * @code
+		 * double sum = 0;
+		 * for (double x: v.getPacked<double>()) sum+=x;
+		 * @endcode
+		 */
+		template<typename T>
+		Range<const T *> getPacked() const;
+
+		///Retrieves flags of the items of packed array
+		/** The flags of the packed array itself contain packedNumbers or packedStrings only.
+		 *
+		 * @return flags shared by all items. For packed numbers, it is numberInteger,
+		 * numberUnsignedInteger (with longInt) for integers, or zero for floating point numbers.
+		 * For packed strings, it can contain plainString. Returns zero, if the value is not packed array
+		 */
+		ValueTypeFlags getPackedItemFlags() const;
+
+		///Retrieves strings of packed string array
+		/** Allows to process the strings without materializing the items
+		 *
+		 * @return view to the strings. If the value is not a packed string array, returns
+		 * an empty view
+		 *
+		 * @code
+		 * for (StringView tag: v.getPackedStrings()) ...
+		 * @endcode
+		 */
+		PackedStringsView getPackedStrings() const;
+
 		///Retrieves type of value
 		/**
 		 * @return type of value
@@ -382,6 +452,43 @@ namespace json {
 		 */
 		Value stripKey() const {return v->unproxy();}
 
+		///Marks the container to remember its serialized text
+		/** Serializing such container for the first time stores the text to the SerializedCache.
+		 * Following serializations copy the text instead of walking the container, even if
+		 * the container is nested in other containers. This is useful for large
+		 * subtrees which are embedded to many documents.
+		 *
+		 * @return new value which is equal to this value and which has the flag serializedCached. Values
+		 * other than arrays and objects are returned unchanged. The key of the value is kept
+		 *
+		 * @see SerializedCache
+		 */
+		Value cacheSerialized() const;
+
+		///Shares equal subtrees
+		/** Subtrees which are equal (and which are serialized the same way) are replaced by
+		 * one shared instance. This reduces memory occupied by documents with repeating
+		 * content. Containers which contain replaced items are created again, other values are kept.
+		 *
+		 * @return deduplicated value. The key of the value is kept
+		 *
+		 * @see DedupTable, Parser::dedupValues
+		 */
+		Value dedup() const;
+
+		///Calculates memory occupied by the value and its content
+		/** Every value is counted once, even if it is reachable through many paths. Values
+		 * referenced from outside of this value (for example by other documents, or
+		 * by variables) are included in the total, but they are not unique.
+		 *
+		 * @return memory usage
+		 *
+		 * @note result is approximation. Buffers shared by many documents (shapes, key tables,
+		 * source text of the zero-copy strings) and the overhead of the allocator are not included. The
+		 * value should not be modified by other threads during the calculation.
+		 */
+		MemoryUsage memoryUsage() const;
+
 		///Binds a key-name to the item
 		/** The function is used by objects, however you can freely bind any value to a specified key outside of the object.
 		 * @param key-name which is bind to the value
@@ -438,6 +545,9 @@ namespace json {
 
 
 		///Performs iteration through all items in the container
+		/** The function can accept Value, or ValueView. The ValueView is faster, because
+		 * it doesn't need to update the reference counters
+		 */
 		template<typename Fn>
 		void forEach(Fn &&fn) const {
 			forEachImpl(fn);
@@ -476,6 +586,16 @@ namespace json {
 		 * @exception ParseError parsing error
 		 */
 		static Value fromString(const BinaryView &string);
+		///Function parses JSON from shared buffer
+		/** Long strings without escape sequences are not copied, they refer to the
+		 * buffer (see StringRefValue). The buffer is kept as long as any such string exists.
+		 * Other strings are copied.
+		 *
+		 * @param buffer shared buffer (see SharedBuffer)
+		 * @return parsed JSON as value
+		 * @exception ParseError parsing error
+		 */
+		static Value fromBuffer(const RefCntPtr<const SharedBuffer> &buffer);
 		///Function parses JSON from standard istream
 		/**
 		 * @param input input stream
@@ -550,6 +670,32 @@ namespace json {
 		 */
 		const PValue &getHandle() const { return v; }
 
+		///Publishes thread local values, so the value can be shared with other threads
+		/** Values created in the LocalTreeScope are marked as thread local. Their reference
+		 * counters are not atomic, so they must not be passed to other threads. This function
+		 * walks the whole tree and converts all thread local values to standard values.
+		 *
+		 * @return reference to this value
+		 *
+		 * @note the function must be called by the thread which created the values
+		 * @see LocalTreeScope
+		 */
+		const Value &publish() const;
+
+		///Makes the whole tree immortal
+		/** Reference counters of immortal values are never updated, so copying of the
+		 * values doesn't need atomic operations. This is useful for large read-only trees which
+		 * are shared by many threads, such a configuration loaded at the startup or templates
+		 * of responses. Thread local values are published.
+		 *
+		 * @return reference to this value
+		 *
+		 * @note immortal values are never released. Freeze only the values, which live
+		 * until the end of the program
+		 * @note the tree must not be accessed by other threads during the function
+		 */
+		const Value &freeze() const;
+
 		///Compares two variables
 		/**
 		 *
@@ -575,6 +721,15 @@ namespace json {
 		 */
 		bool operator!=(const Value &other) const;
 
+		///Retrieves structural hash of the value
+		/** Equal values have equal hash. The key is not included. Arrays and objects calculate
+		 * the hash once and keep it, and the equality of two containers with different
+		 * hashes is then resolved without traversing them.
+		 *
+		 * @see std::hash<json::Value>
+		 */
+		std::size_t hash() const {return v->hash();}
+
 
 		///Returns iterator to the first item
 		/**@note You should be able to iterate through arrays and objects as well */
@@ -1087,6 +1242,10 @@ namespace json {
 		Value filter(Fn &&fn) const;
 
 
+		///Walks through the whole tree
+		/**
+		 * @param fn function which receives Value or ValueView and returns true to enter into the container
+		 */
 		template<typename Fn>
 		void walk(Fn &&fn) const;
 
@@ -1130,7 +1289,8 @@ public:
 
 		///Pointer to custom allocator
 		/** You can change allocator to achieve better results with allocation 
-		   of values of the JSON. By default, standard new and delete is used.
+		   of values of the JSON. By default, the pool allocator is used (see PoolAllocator),
+		   use Allocator::getHeap() to switch to standard new and delete.
 		   This variable is global. By changing it, your allocator must
 		   expect, that some objects are already allocated and will be deallocated
 		   through your deallocator.		   
@@ -1154,6 +1314,10 @@ protected:
 		auto forEachImpl(Fn &fn) const -> decltype(std::declval<Fn>()(std::declval<json::Value>(),std::declval<std::size_t>()),false);
 		template<typename Fn>
 		auto forEachImpl(Fn &fn) const -> decltype(std::declval<Fn>()(std::declval<json::Value>(),std::declval<std::size_t>(), std::declval<json::Value>()),false);
+		template<typename Fn>
+		auto forEachImpl(Fn &fn) const -> decltype(std::declval<Fn>()(std::declval<json::ValueView>()),std::enable_if_t<!std::is_invocable_v<Fn, json::Value>,bool>());
+		template<typename Fn>
+		auto forEachImpl(Fn &fn) const -> decltype(std::declval<Fn>()(std::declval<json::ValueView>(),std::declval<std::size_t>()),std::enable_if_t<!std::is_invocable_v<Fn, json::Value, std::size_t>,bool>());
 
 
 		//std::vector<PValue> prepareValues(const std::initializer_list<Value>& data);
@@ -1312,16 +1476,6 @@ protected:
 		(*this) = bld.commit();
 	}
 
-	template<typename Fn>
-	void Value::walk(Fn &&fn) const {
-		bool enter = fn(*this);
-		if (enter && isContainer()) {
-			for (Value v : *this) {
-				v.walk(fn);
-			}
-		}
-	}
-
 	template<typename InputIterator>
 	inline Value::Value(ValueType type, InputIterator begin, InputIterator end, bool skipUndef) {
 		if (begin == end) {
@@ -1380,4 +1534,5 @@ template<> struct hash<::json::Value> {
 
 
 #include "conv.h"
+#include "valueview.h"
 
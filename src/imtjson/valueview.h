@@ -0,0 +1,196 @@
+#pragma once
+
+#include "value.h"
+#include "abstractValue.h"
+
+namespace json {
+
+	class ValueViewIterator;
+
+	///Non-owning read-only view to a value
+	/** ValueView is a lightweight alternative to the Value for read-only traversal. It doesn't
+	 * hold a reference to the value, so copying the view and accessing the items of
+	 * the containers doesn't update the reference counters.
+	 *
+	 * The view is valid as long as the Value from which it was created exists. Items
+	 * retrieved through the view are valid as long as the parent exists. Containers which
+	 * don't keep their items (see IValue::borrowAtIndex()) create them on demand, the view
+	 * holds a reference to such an item
+	 *
+	 * @code
+	 * double sum = 0;
+	 * for (ValueView item: ValueView(doc)) sum+=item.getNumber();
+	 * @endcode
+	 *
+	 * To keep the item beyond the lifetime of its parent, convert the view to the Value
+	 * using the function toValue()
+	 */
+	class ValueView {
+	public:
+
+		///Constructs undefined view
+		ValueView():v(AbstractValue::getUndefined()) {}
+		///Constructs view to the value
+		explicit ValueView(const Value &v):v(v.getHandle()) {}
+		///Constructs view to the value
+		explicit ValueView(const IValue *v):v(v) {}
+		///Constructs view to the member of an object
+		ValueView(const IValue *v, const StringView &key):v(v),key(key) {}
+
+		ValueType type() const { return v->type(); }
+		ValueTypeFlags flags() const { return v->flags(); }
+		UInt getUInt() const { return v->getUInt(); }
+		Int getInt() const { return v->getInt(); }
+		ULongInt getUIntLong() const { return v->getUIntLong(); }
+		LongInt getIntLong() const { return v->getIntLong(); }
+		double getNumber() const { return v->getNumber(); }
+		bool getBool() const { return v->getBool(); }
+		StringView getString() const { return v->getString(); }
+		///Retrieves the key, if the view refers to a member of an object
+		/** Members of objects are not converted to the values with a key. The key is
+		 * carried by the view instead. The function toValue() doesn't transfer the key */
+		StringView getKey() const { return key.empty()?v->getMemberName():key; }
+		std::size_t size() const { return v->size(); }
+		bool empty() const { return v->size() == 0; }
+		bool defined() const {return type() != undefined;}
+		bool isNull() const {return type() == null;}
+		bool hasValue() const {ValueType t = type(); return t != undefined && t != null;}
+		bool isContainer() const {ValueType t = type(); return t == array || t == object;}
+
+		///Access to item at index
+		ValueView operator[](std::size_t index) const { return itemAt(index); }
+		///Access to member
+		ValueView operator[](const std::string_view &key) const {
+			const IValue *item = v->borrowMember(key);
+			return item?ValueView(item):held(v->member(key));
+		}
+
+		///Converts the view to the Value (takes a reference)
+		Value toValue() const {return Value(PValue(v));}
+
+		///Retrieves pointer to underlying object
+		const IValue *getHandle() const {return v;}
+
+		bool operator==(const ValueView &other) const {
+			return v == other.v || v->equal(other.v);
+		}
+		bool operator!=(const ValueView &other) const {
+			return !operator==(other);
+		}
+
+		ValueViewIterator begin() const;
+		ValueViewIterator end() const;
+
+		///Performs iteration through all items in the container
+		/**
+		 * @param fn function which receives ValueView (and optionally index of the item)
+		 */
+		template<typename Fn>
+		void forEach(Fn &&fn) const {
+			std::size_t cnt = size();
+			for (std::size_t i = 0; i < cnt; i++) {
+				if constexpr(std::is_invocable_v<Fn, ValueView, std::size_t>) {
+					fn(itemAt(i), i);
+				} else {
+					fn(itemAt(i));
+				}
+			}
+		}
+
+		///Walks through the tree
+		/**
+		 * @param fn function which receives ValueView and returns true to enter into the container
+		 */
+		template<typename Fn>
+		void walk(Fn &&fn) const {
+			bool enter = fn(*this);
+			if (enter && isContainer()) {
+				std::size_t cnt = size();
+				for (std::size_t i = 0; i < cnt; i++) {
+					itemAt(i).walk(fn);
+				}
+			}
+		}
+
+		///Access to item at index, members of objects are returned with the key
+		ValueView itemAt(std::size_t index) const {
+			const IValue *item = v->borrowAtIndex(index);
+			if (item == nullptr) return held(v->itemAtIndex(index));
+			if (v->type() == object) return ValueView(item, v->memberNameAtIndex(index));
+			else return ValueView(item);
+		}
+
+	protected:
+		const IValue *v;
+		StringView key;
+		///Reference to the item, which is not kept by its container
+		PValue hold;
+
+		static ValueView held(const PValue &item) {
+			ValueView res(static_cast<const IValue *>(item));
+			res.hold = item;
+			return res;
+		}
+	};
+
+	///Iterator over items of ValueView
+	class ValueViewIterator {
+	public:
+		const IValue *v;
+		std::size_t index;
+
+		ValueViewIterator(const IValue *v, std::size_t index):v(v),index(index) {}
+		ValueView operator *() const {return ValueView(v).itemAt(index);}
+		ValueViewIterator &operator++() {++index;return *this;}
+		ValueViewIterator operator++(int) {++index;return ValueViewIterator(v,index-1);}
+		ValueViewIterator &operator--() {--index;return *this;}
+		ValueViewIterator operator--(int) {--index;return ValueViewIterator(v,index+1);}
+
+		bool operator==(const ValueViewIterator &other) const {
+			return index == other.index && v == other.v;
+		}
+		bool operator!=(const ValueViewIterator &other) const {
+			return !operator==(other);
+		}
+		ValueViewIterator &operator+=(Int p) {index+=p;return *this;}
+		ValueViewIterator &operator-=(Int p) {index-=p;return *this;}
+		ValueViewIterator operator+(Int p) const {return ValueViewIterator(v,index+p);}
+		ValueViewIterator operator-(Int p) const {return ValueViewIterator(v,index-p);}
+		Int operator-(const ValueViewIterator &other) const {return index - other.index;}
+
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef ValueView value_type;
+		typedef ValueView *pointer;
+		typedef ValueView &reference;
+		typedef Int difference_type;
+	};
+
+	inline ValueViewIterator ValueView::begin() const {return ValueViewIterator(v,0);}
+	inline ValueViewIterator ValueView::end() const {return ValueViewIterator(v,size());}
+
+	template<typename Fn>
+	auto Value::forEachImpl(Fn &fn) const -> decltype(std::declval<Fn>()(std::declval<json::ValueView>()),std::enable_if_t<!std::is_invocable_v<Fn, json::Value>,bool>()) {
+		ValueView(*this).forEach(fn);
+		return true;
+	}
+	template<typename Fn>
+	auto Value::forEachImpl(Fn &fn) const -> decltype(std::declval<Fn>()(std::declval<json::ValueView>(),std::declval<std::size_t>()),std::enable_if_t<!std::is_invocable_v<Fn, json::Value, std::size_t>,bool>()) {
+		ValueView(*this).forEach(fn);
+		return true;
+	}
+
+	template<typename Fn>
+	void Value::walk(Fn &&fn) const {
+		if constexpr(std::is_invocable_v<Fn, Value>) {
+			bool enter = fn(*this);
+			if (enter && isContainer()) {
+				for (Value v : *this) {
+					v.walk(fn);
+				}
+			}
+		} else {
+			ValueView(*this).walk(fn);
+		}
+	}
+
+}
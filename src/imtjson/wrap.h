@@ -44,6 +44,10 @@ namespace _details {
 		virtual StringView getString() const {return pv->getString();}
 		virtual std::size_t size() const {return pv->size();}
 		virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const {return pv->itemAtIndex(index);}
+		virtual const IValue *borrowAtIndex(std::size_t index) const {return pv->borrowAtIndex(index);}
+		virtual const IValue *borrowMember(const std::string_view &name) const {return pv->borrowMember(name);}
+		virtual StringView memberNameAtIndex(std::size_t index) const {return pv->memberNameAtIndex(index);}
+		virtual const IValue *memberKeyAtIndex(std::size_t index) const {return pv->memberKeyAtIndex(index);}
 		virtual RefCntPtr<const IValue> member(const std::string_view &name) const {return pv->member(name);}
 
 		///some values are proxies with member name - this retrieves name
@@ -79,6 +83,12 @@ namespace _details {
 		virtual void throwPtr() const override{
 			throw &obj;
 		}
+		virtual bool forEachRef(const IEnumFn &fn) const override {
+			return fn(pv);
+		}
+		virtual std::size_t hash() const override {return pv->hash();}
+		virtual std::size_t cachedHash() const override {return pv->cachedHash();}
+		virtual std::size_t memorySize() const override {return sizeof(ObjWrap);}
 
 
 	protected:
@@ -5,6 +5,7 @@
 #endif
 #include <fcntl.h>
 #include <fstream>
+#include <iterator>
 #include "../imtjson/json.h"
 #include "../imtjson/compress.tcc"
 
@@ -19,7 +20,9 @@ int main(int argc, char **argv)
 
 	
 		using namespace json;
-		Value v = Value::fromStream(std::cin);
+		//whole input is read at once, parsing of the buffer is faster
+		std::string input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+		Value v = Value::fromString(input);
 		v.serialize(emitUtf8,compress(toStream(std::cout)));
 
 		return 0;
@@ -22,8 +22,16 @@
 #include "../imtjson/streams.h"
 #include "../imtjson/valueref.h"
 #include "../imtjson/wrap.h"
+#include "../imtjson/chunkMap.h"
+#include "../imtjson/keyTable.h"
+#include "../imtjson/shapeValue.h"
+#include "../imtjson/smallObjectValue.h"
+#include "../imtjson/sharedBuffer.h"
+#include "../imtjson/indexedParser.h"
 #include "testClass.h"
 #include <random>
+#include <unordered_set>
+#include <thread>
 
 using namespace json;
 
@@ -349,7 +357,7 @@ int testMain(bool showOutput) {
 		}
 		Value(res).toStream(out);
 	};
-	tst.test("Serialize.valueHash", sizeof(std::size_t)==8?"13532798998175024480":"149136928") >> [](std::ostream &out) {
+	tst.test("Serialize.valueHash", sizeof(std::size_t)==8?"10313494846119809812":"1407287636") >> [](std::ostream &out) {
 		Value v = Value::fromString("{\"a\":7,\"b\":{\"a\":2,\"b\":{\"a\":3,\"b\":{\"a\":4}},\"c\":6}}");
 		std::hash<Value> hv;
 		out << hv(v);
@@ -1439,6 +1447,578 @@ tst.test("Object.enumItems", "age:19,data:[90,60,90],frobla:12.3,kabrt:289,name:
 		out << map_bin2str(z.getBinary(utf8encoding));
 	};
 
+	tst.test("arena.parse","{\"a\":[1,2.5,\"text\",true,null],\"b\":{\"c\":\"long string value\"}} true true") >> [](std::ostream &out) {
+		std::string_view str = "{\"a\":[1,2.5,\"text\",true,null],\"b\":{\"c\":\"long string value\"}}";
+		std::size_t pos = 0;
+		auto fn = [&]() -> char {return pos < str.length()?str[pos++]:-1;};
+		Value v;
+		{
+			Parser<decltype(fn)> p(std::move(fn), Parser<decltype(fn)>::useArena);
+			v = p.parse();
+		}
+		out << v.toString() << " "
+			<< (ChunkMap::find(v.getHandle()) != nullptr?"true":"false") << " "
+			<< (ChunkMap::find(v["b"]["c"].getHandle()) != nullptr?"true":"false");
+	};
+	tst.test("arena.lifetime","held 1 [1,2,3] 1") >> [](std::ostream &out) {
+		PArena arena = Arena::create();
+		Value v;
+		{
+			ArenaScope scope(arena);
+			v = Value::fromString("[1,2,3]");
+		}
+		out << (arena->use_count() > 1?"held":"free") << " ";
+		v = Value();
+		out << arena->use_count() << " ";
+		{
+			ArenaScope scope(arena);
+			v = Value::fromString("[1,2,3]");
+		}
+		arena = nullptr;
+		out << v.toString() << " " << (Arena::current() == nullptr?1:0);
+	};
+	tst.test("arena.binary","true true") >> [](std::ostream &out) {
+		Value v = Value::fromString("{\"a\":[1,2,3],\"b\":\"text\"}");
+		std::vector<unsigned char> buff;
+		v.serializeBinary([&](unsigned char c){buff.push_back(c);});
+		std::size_t pos = 0;
+		auto fn = [&]{return buff[pos++];};
+		BinaryParser<decltype(fn)> p(fn, defaultBinaryEncoding, Arena::create());
+		Value w = p.parse();
+		out << (w == v?"true":"false") << " " << (ChunkMap::find(w.getHandle()) != nullptr?"true":"false");
+	};
+
+	tst.test("pool.threads","true 1000 499500") >> [](std::ostream &out) {
+		Value v = Value::fromString("{\"a\":[1,2,3],\"b\":\"text\"}");
+		out << (ChunkMap::find(v.getHandle()) != nullptr?"true":"false") << " ";
+		std::vector<Value> values;
+		std::thread thr([&]{
+			for (int i = 0; i < 1000; i++) values.push_back(Value(json::array,{i,std::to_string(i)}));
+		});
+		thr.join();
+		double sum = 0;
+		for (Value x: values) sum += x[0].getNumber();
+		out << values.size() << " " << sum;
+		std::thread thr2([&]{values.clear();});
+		thr2.join();
+	};
+	tst.test("pool.switch","[1,2,3] [4,5,6]") >> [](std::ostream &out) {
+		Value a = {1,2,3};
+		Value::allocator = Allocator::getHeap();
+		Value b = {4,5,6};
+		Value::allocator = Allocator::getPool();
+		out << a.toString() << " " << b.toString();
+		a = b;
+	};
+
+	tst.test("smallint.shared","true true false true true -128 1023 1024") >> [](std::ostream &out) {
+		Value a = 42;
+		Value b = Value::fromString("42");
+		Value c = 42U;
+		out << (b.getHandle() == c.getHandle()?"true":"false") << " "
+			<< (a.getHandle()->isImmortal()?"true":"false") << " "
+			<< (a.getHandle() == c.getHandle()?"true":"false") << " "
+			<< ((a.flags() & numberInteger) != 0?"true":"false") << " "
+			<< ((c.flags() & numberUnsignedInteger) != 0?"true":"false") << " "
+			<< Value(-128).getInt() << " " << Value(1023U).getUInt() << " " << Value(1024).getInt();
+	};
+	tst.test("immortal.static","true true true") >> [](std::ostream &out) {
+		Value a = nullptr;
+		Value b = true;
+		Value c = json::array;
+		out << (a.getHandle()->isImmortal()?"true":"false") << " "
+			<< (b.getHandle()->isImmortal()?"true":"false") << " "
+			<< (c.getHandle()->isImmortal()?"true":"false");
+	};
+
+	tst.test("localtree.publish","true true 1 false false false 2 [1.5,\"text\",{\"a\":\"x\"}]") >> [](std::ostream &out) {
+		Value v;
+		{
+			LocalTreeScope scope;
+			v = Value::fromString("[1.5,\"text\",{\"a\":\"x\"}]");
+		}
+		Value item = v[2]["a"].stripKey();
+		out << (v.getHandle()->isLocal()?"true":"false") << " "
+			<< (item.getHandle()->isLocal()?"true":"false") << " "
+			<< v.getHandle().use_count() << " ";
+		v.publish();
+		out << (v.getHandle()->isLocal()?"true":"false") << " "
+			<< (item.getHandle()->isLocal()?"true":"false") << " "
+			<< (v[0].getHandle()->isLocal()?"true":"false") << " ";
+		Value w;
+		std::thread thr([&]{w = v;});
+		thr.join();
+		out << v.getHandle().use_count() << " " << w.toString();
+	};
+
+	tst.test("localtree.publishShared","false false") >> [](std::ostream &out) {
+		Value v;
+		Value leaf;
+		{
+			LocalTreeScope scope;
+			leaf = Value(std::string("leaf text"));
+			v = leaf;
+			//every level refers the previous level twice, paths to the leaf double on every level
+			for (int i = 0; i < 64; i++) v = Value(array, {v, v});
+		}
+		v.publish();
+		out << (v.getHandle()->isLocal()?"true":"false") << " "
+			<< (leaf.getHandle()->isLocal()?"true":"false");
+	};
+
+	tst.test("valueview.iterate","22.5 1.5 text 2 c=true 1 6") >> [](std::ostream &out) {
+		Value v = Value::fromString("[1,2,3,[4,5,6],{\"a\":1.5,\"b\":\"text\",\"c\":true}]");
+		double sum = 0;
+		v.walk([&](ValueView x) {
+			if (x.type() == json::number) sum+=x.getNumber();
+			return true;
+		});
+		ValueView view(v);
+		out << sum << " " << view[4]["a"].getNumber() << " " << view[4]["b"].getString() << " ";
+		std::size_t cnt = 0;
+		for (ValueView x: view[3]) if (x.getUInt() > 4) cnt++;
+		out << cnt << " ";
+		view[4].forEach([&](ValueView x, std::size_t idx) {
+			if (idx == 2) out << x.getKey() << "=" << (x.getBool()?"true":"false") << " ";
+		});
+		Value copy = view[3][2].toValue();
+		out << v.getHandle().use_count() << " " << copy.getUInt();
+	};
+
+	tst.test("valueview.customArray","[0,10.5,21] 10.5 31.5 1 0 1 0") >> [](std::ostream &out) {
+		//array which doesn't implement the borrowing functions, its items are created on demand
+		class Item: public AbstractNumberValue {
+		public:
+			Item(double v, int &live):v(v),live(live) {++live;}
+			~Item() {--live;}
+			virtual double getNumber() const override {return v;}
+			virtual Int getInt() const override {return static_cast<Int>(v);}
+			virtual UInt getUInt() const override {return static_cast<UInt>(v);}
+			virtual LongInt getIntLong() const override {return static_cast<LongInt>(v);}
+			virtual ULongInt getUIntLong() const override {return static_cast<ULongInt>(v);}
+		protected:
+			double v;
+			int &live;
+		};
+		class RangeArray: public AbstractArrayValue {
+		public:
+			RangeArray(int &live):live(live) {}
+			virtual std::size_t size() const override {return 3;}
+			virtual RefCntPtr<const IValue> itemAtIndex(std::size_t index) const override {
+				return index < 3?PValue(new Item(index * 10.5, live)):PValue(getUndefined());
+			}
+		protected:
+			int &live;
+		};
+		int live = 0;
+		Value v(PValue(new RangeArray(live)));
+		double sum = 0;
+		for (ValueView x: ValueView(v)) sum += x.getNumber();
+		out << v.stringify() << " " << ValueView(v)[1].getNumber() << " " << sum << " " << (v == Value(array, {0.0, 10.5, 21.0})) << " "
+			<< Value::compare(v, Value(array, {0.0, 10.5, 21.0})) << " " << (v.hash() == Value(array, {0.0, 10.5, 21.0}).hash()) << " ";
+		out << live;
+	};
+
+	tst.test("object.entries","a=1 b=2 c=3 b b {\"a\":1,\"b\":2,\"c\":3} true") >> [](std::ostream &out) {
+		Value v = Value::fromString("{\"c\":3,\"a\":1,\"b\":2}");
+		for (Value x: v) out << x.getKey() << "=" << x.getUInt() << " ";
+		out << v["b"].getKey() << " " << ValueView(v).itemAt(1).getKey() << " ";
+		std::vector<char> buff;
+		v.serializeBinary([&](char c){buff.push_back(c);});
+		auto iter = buff.begin();
+		Value w = Value::parseBinary([&]{return *iter++;});
+		out << w.toString() << " " << (w == v?"true":"false");
+	};
+
+	tst.test("object.cachedMembers","1 1 a 1 1 a 1 1 a") >> [](std::ostream &out) {
+		std::string rest = "\"c\":0,\"d\":0,\"e\":0,\"f\":0,\"g\":0,\"h\":0,\"i\":0";
+		Value small = Value::fromString("{\"b\":2,\"a\":1}");
+		Object big(small);
+		for (int i = 0; i < 10; i++) big.set("x"+std::to_string(i), i);
+		Value shapes = Value::fromString("[{\"a\":1,\"b\":2,"+rest+"},{\"a\":3,\"b\":4,"+rest+"}]");
+		//members returned with the key are created once and kept by the object
+		const char *sep = "";
+		for (Value v: {small, Value(big), shapes[1]}) {
+			out << sep << (v["a"].getHandle() == v["a"].getHandle()) << " " << (v[0].getHandle() == v["a"].getHandle()) << " "
+				<< v["a"].getKey();
+			sep = " ";
+		}
+	};
+
+	tst.test("object.commitWrapped","{\"a\":1,\"b\":2,\"c\":3}") >> [](std::ostream &out) {
+		int payload = 42;
+		Value base = makeValue(payload, Object({{"a",1},{"c",3}}));
+		Object o(base);
+		o.set("b",2);
+		Value(o).toStream(out);
+	};
+
+	tst.test("object.sharedKeys","true false") >> [](std::ostream &out) {
+		Value v = Value::fromString("[{\"id\":1},{\"id\":2},{\"name\":3}]");
+		out << (getKeyObject(v[0][0]).getHandle() == getKeyObject(v[1][0]).getHandle()?"true":"false") << " "
+			<< (getKeyObject(v[0][0]).getHandle() == getKeyObject(v[2][0]).getHandle()?"true":"false");
+	};
+
+	tst.test("keytable.intern","true true 3") >> [](std::ostream &out) {
+		{
+			Value a = Value::fromString("{\"intern_test_key\":1}");
+			Object o;
+			o.set("intern_test_key",2);
+			Value b(o);
+			std::string_view str = "{\"intern_test_key\":1}";
+			std::size_t pos = 0;
+			auto fn = [&]() -> char {return pos < str.length()?str[pos++]:-1;};
+			Value c = Parser<decltype(fn)>(std::move(fn), Parser<decltype(fn)>::useArena).parse();
+			out << (getKeyObject(a[0]).getHandle() == getKeyObject(b[0]).getHandle()?"true":"false") << " "
+				<< (getKeyObject(a[0]).getHandle() == getKeyObject(c[0]).getHandle()?"true":"false") << " ";
+		}
+		KeyTable::sweep();
+		out << KeyTable::intern("intern_test_key").getHandle().use_count();
+	};
+
+	tst.test("shape.shared","true true 3 b true {\"a\":3,\"b\":4,\"c\":0,\"d\":0,\"e\":0,\"f\":0,\"g\":0,\"h\":0,\"i\":0,\"z\":7} true") >> [](std::ostream &out) {
+		std::string rest = "\"c\":0,\"d\":0,\"e\":0,\"f\":0,\"g\":0,\"h\":0,\"i\":0";
+		Value a = Value::fromString("[{\"a\":1,\"b\":2,"+rest+"},{"+rest+",\"b\":4,\"a\":3}]");
+		Value b = Value::fromString("{\"a\":5,\"b\":6,"+rest+"}");
+		auto getShape = [](const Value &v) {
+			const ShapeObjectValue *s = dynamic_cast<const ShapeObjectValue *>(v.getHandle()->unproxy());
+			return s?static_cast<const Shape *>(s->getShape()):nullptr;
+		};
+		out << (getShape(a[0]) != nullptr && getShape(a[0]) == getShape(a[1])?"true":"false") << " "
+			<< (getShape(a[0]) == getShape(b)?"true":"false") << " "
+			<< a[1]["a"].getUInt() << " " << a[1][1].getKey() << " "
+			<< (a.toString() == "[{\"a\":1,\"b\":2,"+rest+"},{\"a\":3,\"b\":4,"+rest+"}]"?"true":"false") << " ";
+		Object o(a[1]);
+		o.set("z",7);
+		out << Value(o).toString() << " " << (a[1] == Value::fromString("{\"a\":3,\"b\":4,"+rest+"}")?"true":"false");
+	};
+
+	tst.test("object.small","true 3 {\"a\":1,\"b\":2,\"c\":3} <undefined> true false {\"a\":1,\"c\":3,\"d\":4} true") >> [](std::ostream &out) {
+		Value a = Value::fromString("{\"c\":3,\"a\":1,\"b\":2}");
+		auto isSmall = [](const Value &v) {
+			return dynamic_cast<const SmallObjectValue *>(v.getHandle()->unproxy()) != nullptr;
+		};
+		out << (isSmall(a)?"true":"false") << " " << a["c"].getUInt() << " " << a.toString() << " " << a["d"].toString() << " ";
+		Object o(a);
+		o.unset("b");
+		o.set("d",4);
+		Value b(o);
+		Object big(a);
+		for (int i = 0; i < 10; i++) big.set("x"+std::to_string(i), i);
+		out << (isSmall(b)?"true":"false") << " " << (isSmall(Value(big))?"true":"false") << " " << b.toString() << " "
+			<< (a == Value(Object({{"a",1},{"b",2},{"c",3}}))?"true":"false");
+	};
+
+	tst.test("object.hashIndex","1000 499500 <undefined> 1001 42") >> [](std::ostream &out) {
+		Object o;
+		for (unsigned int i = 0; i < 1000; i++) o.set("key"+std::to_string(i), i);
+		Value v(o);
+		std::size_t found = 0, sum = 0;
+		for (unsigned int i = 0; i < 1000; i++) {
+			Value x = v["key"+std::to_string(i)];
+			if (x.defined()) {found++; sum += x.getUInt();}
+		}
+		out << found << " " << sum << " " << v["key1000"].toString() << " ";
+		Object o2(v);
+		o2.set("key1000", 42);
+		Value w(o2);
+		out << w.size() << " " << w["key1000"].getUInt();
+	};
+
+	tst.test("object.keyLayout","13 0 113 0") >> [](std::ostream &out) {
+		std::vector<std::string> keys = {"a","ab","abc","abcdefgh","abcdefghi","abcdefgh0",
+				"b",std::string("ab\0",3),"longer_common_prefix_1","longer_common_prefix_2","longer_common_prefix_10","",std::string(70000,'x')};
+		std::vector<std::string> missing = {"abcd","abcdefg","abcdefghij","longer_common_prefix_","longer_common_prefix_3","c",std::string("a\0",2),
+				std::string(70001,'x'),std::string(69999,'x')+"y"};
+		for (std::size_t extra: {0,100}) {
+			Object o;
+			for (const auto &k: keys) o.set(k, true);
+			for (std::size_t i = 0; i < extra; i++) o.set("extra"+std::to_string(i), true);
+			Value v(o);
+			std::size_t found = 0, notfound = 0;
+			for (const auto &k: keys) if (v[k].defined()) found++;
+			for (std::size_t i = 0; i < extra; i++) if (v["extra"+std::to_string(i)].defined()) found++;
+			for (const auto &k: missing) if (v[k].defined()) notfound++;
+			out << found << " " << notfound << (extra?"":" ");
+		}
+	};
+	tst.test("array.packed","packed 95 1.5 20 1 0 1 1 1 1 1 1 1 [\"a\",\"b\"]") >> [](std::ostream &out) {
+		enableParsePackedArrays = true;
+		std::vector<double> d;
+		for (int i = 0; i < 20; i++) d.push_back(i*0.5);
+		Value a = Value::from(d);
+		double sum = 0;
+		for (double x: a.getPacked<double>()) sum+=x;
+		out << ((a.flags() & packedNumbers)?"packed ":"plain ") << sum << " " << a[3].getNumber() << " ";
+
+		std::string txt = "[", txt2 = "[";
+		for (int i = 0; i < 20; i++) {
+			if (i) {txt.push_back(',');txt2.push_back(',');}
+			txt.append(std::to_string(i+1));
+			txt2.append(i%2?std::to_string(i-10):std::to_string(i)+".25");
+		}
+		txt.push_back(']');txt2.push_back(']');
+		Value p = Value::fromString(txt);
+		out << p.getPacked<ULongInt>().size() << " " << (p.toString() == txt) << " ";
+		//integers mixed with floating point numbers keep their types
+		Value p2 = Value::fromString(txt2);
+		out << p2.getPacked<double>().size() << " " << (p2.toString() == txt2) << " " << ((p2[1].flags() & numberInteger) != 0) << " ";
+		out << ((p.getPackedItemFlags() & numberUnsignedInteger) != 0) << " " << ((p.flags() & numberUnsignedInteger) == 0) << " ";
+
+		std::vector<char> buff;
+		p.serializeBinary([&](char c){buff.push_back(c);});
+		auto iter = buff.begin();
+		Value c = Value::parseBinary([&]{return *iter++;});
+		out << (c == p && c.getPacked<ULongInt>().size() == 20) << " ";
+
+		std::vector<Value> items(p.begin(), p.end());
+		Value plain(array, items.begin(), items.end());
+		out << (plain == p && p == plain) << " " << (p[19].getUInt() == 20) << " ";
+		out << Value::from(std::vector<std::string>{"a","b"}).toString();
+		enableParsePackedArrays = false;
+	};
+	tst.test("array.packedStrings","packed 20 tag7 1 1 1 1 3 [\"x\",\"\",\"y\\n\"]") >> [](std::ostream &out) {
+		std::string txt = "[";
+		for (int i = 0; i < 20; i++) {
+			if (i) txt.push_back(',');
+			txt.append("\"tag"+std::to_string(i)+"\"");
+		}
+		txt.push_back(']');
+		enableParsePackedArrays = true;
+		Value p = Value::fromString(txt);
+		std::size_t n = 0;
+		for (StringView s: p.getPackedStrings()) if (s.substr(0,3) == "tag") n++;
+		out << ((p.flags() & packedStrings)?"packed ":"plain ") << n << " " << p[7].getString() << " ";
+		out << (p.toString() == txt) << " ";
+
+		std::vector<char> buff;
+		p.serializeBinary([&](char c){buff.push_back(c);});
+		auto iter = buff.begin();
+		Value c = Value::parseBinary([&]{return *iter++;});
+		out << (c == p && c.getPackedStrings().size() == 20) << " ";
+
+		std::vector<Value> items(p.begin(), p.end());
+		Value plain(array, items.begin(), items.end());
+		out << (plain == p && p == plain) << " ";
+
+		txt.insert(1,"\"a string which is too long to be packed into the packed array of strings\",");
+		out << (Value::fromString(txt).getPackedStrings().size() == 0) << " ";
+		Value v = Value::from(std::vector<std::string_view>{"x","","y\n"});
+		out << v.getPackedStrings().size() << v[1].getString() << " " << v.toString();
+		enableParsePackedArrays = false;
+	};
+	tst.test("string.zeroCopy","1 0 0 0 1 1 2 1") >> [](std::ostream &out) {
+		std::string longText(100,'x');
+		PSharedBuffer buff = SharedBuffer::create("{\"a\":\""+longText+"\",\"b\":\"short\",\"c\":\""+longText+"\\n\",\"d\":\""+longText+"\u00e1\"}");
+		std::string_view data = buff->getData();
+		auto inBuffer = [&](const Value &v) {
+			std::string_view s = v.getString();
+			return s.data() >= data.data() && s.data() < data.data()+data.size();
+		};
+		Value v = Value::fromBuffer(buff);
+		out << inBuffer(v["a"]) << " " << inBuffer(v["b"]) << " " << inBuffer(v["c"]) << " " << inBuffer(v["d"]) << " ";
+		out << (std::strlen(String(v["a"]).c_str()) == 100) << " " << (v["c"].getString() == longText+"\n") << " ";
+		long uses = buff.use_count();
+		v = Value();
+		out << uses << " " << buff.use_count();
+	};
+	tst.test("string.plain","1 0 0 1 0 1") >> [](std::ostream &out) {
+		auto plain = [](const Value &v) {return (v.flags() & plainString) != 0;};
+		std::string text = R"({"a":"text","b\"":["a\tb","\u010D"],"c":["x","x","x","x","x","x","x","x","x","x","x","x","x","x","x","x"]})";
+		Value v = Parser<StreamFromString>(StreamFromString(text), Parser<StreamFromString>::packArrays).parse();
+		out << plain(v["a"]) << " " << plain(v["b\""][0]) << " " << plain(v["b\""][1]) << " "
+			<< plain(v["c"]) << " " << plain(Value("\x01")) << " "
+			<< (v.stringify() == text);
+	};
+	tst.test("serialize.cached","{\"id\":1,\"user\":{\"city\":\"Praha\",\"name\":\"Ondra\",\"tags\":[\"a\",\"\\u010D\"]}} {\"id\":2,\"user\":{\"city\":\"Praha\",\"name\":\"Ondra\",\"tags\":[\"a\",\"\u010D\"]}} 1 1 1 1") >> [](std::ostream &out) {
+		std::size_t before = SerializedCache::usage();
+		Value profile = Value::fromString(R"({"name":"Ondra","city":"Praha","tags":["a","\u010D"]})").cacheSerialized();
+		Value msg1(object, {Value("id",1), Value("user",profile)});
+		Value msg2(object, {Value("id",2), Value("user",profile)});
+		out << msg1.stringify() << " " << msg2.stringify(emitUtf8) << " "
+			<< (msg1.stringify() == msg1.toString()) << " "
+			<< ((msg2["user"].flags() & serializedCached) != 0) << " "
+			<< (SerializedCache::usage() > before) << " ";
+		profile = msg1 = msg2 = Value();
+		out << (SerializedCache::usage() == before);
+	};
+	tst.test("serialize.cachedEvict","0 1 1 1") >> [](std::ostream &out) {
+		SerializedCache::clear();
+		Value a = Value(array, {"aaaaaaaaaaaaaaaa"}).cacheSerialized();
+		Value b = Value(array, {"bbbbbbbbbbbbbbbb"}).cacheSerialized();
+		Value c = Value(array, {"cccccccccccccccc"}).cacheSerialized();
+		std::size_t sz = a.stringify().length();
+		SerializedCache::setBudget(sz * 2 + sz / 2);
+		b.stringify();
+		a.stringify();
+		b.stringify();
+		c.stringify();
+		out << !SerializedCache::lookup(a.getHandle(), false).empty() << " "
+			<< !SerializedCache::lookup(b.getHandle(), false).empty() << " "
+			<< !SerializedCache::lookup(c.getHandle(), false).empty() << " "
+			<< (SerializedCache::usage() == sz * 2);
+		SerializedCache::setBudget(SerializedCache::defaultBudget);
+		SerializedCache::clear();
+	};
+	tst.test("Value.hash","1 1 1 1 0 0 1 2") >> [](std::ostream &out) {
+		Value a = Value::fromString(R"({"x":[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16],"y":{"z":"text"}})");
+		Value b(object, {
+			Value("y", Value(object, {Value("z","text")})),
+			Value("x", Value(array, {1.0,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16}))
+		});
+		Value c = a.replace("y", Value(object, {Value("z","other")}));
+		out << (a.hash() == b.hash()) << " " << (a == b) << " "
+			<< (a["x"].hash() == Value(array, {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16}).hash()) << " "
+			<< (Value(-0.0).hash() == Value(0).hash()) << " "
+			<< (a.hash() == c.hash()) << " " << (a == c) << " "
+			<< (a["y"].hash() == a["y"].setKey("w").hash()) << " ";
+		std::unordered_set<Value> set = {a, b, c};
+		out << set.size();
+	};
+	tst.test("Value.dedup","1 0 1 1 1 0 1 1 1") >> [](std::ostream &out) {
+		std::string text = R"([{"addr":{"city":"Praha","zip":"11000"},"n":2.5},{"addr":{"city":"Praha","zip":"11000"},"n":2.5},{"addr":{"city":"Praha","zip":"11000"},"n":1e300},{"n":1000000},{"n":1000000.0}])";
+		auto same = [](const Value &a, const Value &b) {return a.stripKey().getHandle() == b.stripKey().getHandle();};
+		Value v = Value::fromString(text);
+		Value d = v.dedup();
+		out << same(d[0], d[1]) << " " << same(v[0]["addr"], v[1]["addr"]) << " "
+			<< same(d[0]["addr"], d[2]["addr"]) << " " << (d == v) << " " << (d.stringify() == v.stringify()) << " "
+			<< same(d[3], d[4]) << " ";
+		StreamFromString str(text);
+		Value p = Parser<const StreamFromString &>(str, Parser<const StreamFromString &>::dedupValues).parse();
+		out << same(p[0], p[1]) << " " << same(p[0]["addr"], p[2]["addr"]) << " " << (p == v);
+	};
+	tst.test("Value.memoryUsage","1 1 1 1 1 1 1") >> [](std::ostream &out) {
+		Value shared = Value::fromString(R"({"city":"Praha","zip":"11000","tags":["a","b","c"]})");
+		Value doc(json::array,{shared, shared, Value::fromString(R"({"name":"Bob"})")});
+		MemoryUsage u1 = doc.memoryUsage();
+		MemoryUsage s = shared.memoryUsage();
+		shared = Value();
+		MemoryUsage u2 = doc.memoryUsage();
+		Value copy = doc;
+		MemoryUsage u3 = doc.memoryUsage();
+		out << (u1.total == u2.total) << " " << (s.unique == 0) << " "
+			<< (u2.unique > u1.unique) << " " << (u3.unique == 0) << " "
+			<< (u1.total < Value::fromString(doc.stringify()).memoryUsage().total) << " "
+			<< (u2.byType[json::array] == u2.uniqueByType[json::array]) << " "
+			<< (s.count + 4 == u1.count);
+	};
+	tst.test("Value.freeze","1 1 1 1 1 0 1") >> [](std::ostream &out) {
+		Value v = Value::fromString(R"({"name":"server","ports":[8080,8081],"opts":{"tls":true}})");
+		double nums[] = {1.5, 2.5, 3.5};
+		Value packed = Value::packedArray(nums, 3);
+		Value doc(json::array,{v, packed});
+		doc.freeze();
+		const IValue *opts = v["opts"].stripKey().getHandle();
+		long cnt = opts->use_count();
+		{
+			Value copy = v["opts"];
+			Value copy2 = copy;
+			out << (cnt == opts->use_count()) << " ";
+		}
+		out << doc.getHandle()->isImmortal() << " " << opts->isImmortal() << " "
+			<< packed[1].getHandle()->isImmortal() << " " << (doc.stringify() == R"([{"name":"server","opts":{"tls":true},"ports":[8080,8081]},[1.5,2.5,3.5]])") << " ";
+		Value other = Value(json::array,{1.5, 2.5});
+		out << other.getHandle()->isImmortal() << " " << (doc.memoryUsage().unique == 0);
+	};
+	tst.test("Parser.contiguous","1 1 1 1 2 3") >> [](std::ostream &out) {
+		std::string text = " \t{\"short\":\"ab\", \"long string key\" : \"0123456789abcdefghij\\\"quoted\\\" and \\u00e9 ščř plain tail\","
+				"\"n\":[ -12 , 3.5e2 ,18446744073709551615, true, null ]} ";
+		std::size_t pos = 0;
+		Value v = Value::fromString(text);
+		Value w = Value::parse([&]() -> int {return pos < text.size()?static_cast<unsigned char>(text[pos++]):-1;});
+		out << (v == w) << " " << (v.stringify() == w.stringify()) << " "
+			<< (v["long string key"].getString() == "0123456789abcdefghij\"quoted\" and \u00e9 ščř plain tail") << " ";
+		StreamFromString str("\"\\u0041\xC3\xA1\" 2 [3]");
+		Value a = Parser<const StreamFromString &>(str).parse();
+		Value b = Parser<const StreamFromString &>(str).parse();
+		Value c = Parser<const StreamFromString &>(str).parse();
+		out << (a.getString() == "A\xC3\xA1") << " " << b.getUInt() << " " << c[0].getUInt();
+	};
+	tst.test("Parse.numberExact","1 1 1 18446744073709551615 1 -9223372036854775807 12345678901234567") >> [](std::ostream &out) {
+		bool exact = true, exactStream = true;
+		for (const char *t: {"0.1", "0.30000000000000004", "2.2250738585072014e-308", "1.7976931348623157e308", "5e-324",
+				"4.9406564584124654e-324", "123456789012345678901234567890", "1e23", "8.98846567431158e307", "+2.5",
+				"9007199254740993.0", "1.00000000000000011102230246251565404236316680908203125", "7.038531e-26", ".5e-3", "1e400", "1e-400"}) {
+			double d = std::strtod(t[0] == '+'?t+1:t, nullptr);
+			double v = Value::fromString(t).getNumber();
+			std::string_view str(t);
+			std::size_t pos = 0;
+			double w = Value::parse([&]() -> int {return pos < str.size()?str[pos++]:-1;}).getNumber();
+			exact = exact && std::memcmp(&d, &v, sizeof(d)) == 0;
+			exactStream = exactStream && std::memcmp(&d, &w, sizeof(d)) == 0;
+		}
+		out << exact << " " << exactStream << " " << (Value::fromString("18446744073709551616").flags() & numberUnsignedInteger?0:1) << " "
+			<< Value::fromString("18446744073709551615").getUIntLong() << " "
+			<< (Value::fromString("-9223372036854775808").flags() & numberInteger?0:1) << " "
+			<< Value::fromString("-9223372036854775807").getIntLong() << " "
+			<< Value::fromString("12345678901234567").getUIntLong();
+	};
+	tst.test("IndexedParser.parse","1 1 1 1 1 1") >> [](std::ostream &out) {
+		std::string text;
+		{
+			std::ifstream infile("src/tests/test.json", std::ifstream::binary);
+			text.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+		}
+		std::ostringstream buff;
+		buff << "[";
+		for (int i = 0; i < 200; i++) {
+			//sequences of backslashes and quotes cross the blocks of the index
+			buff << "{\"k" << std::string(i % 70, 'x') << "\":\"" << std::string(i % 9, '\\') << std::string(i % 9, '\\')
+				 << "\\\"" << std::string(i % 67, 'y') << "\\u00e9\", \"n\":[-" << i << ".5e1,true ,\tnull,false]},\"\",\"" << std::string(i, '"' - 1) << "\",";
+		}
+		buff << "{}]";
+		std::string gen = buff.str();
+		bool ok = true;
+		for (const std::string &t: {text, gen}) {
+			Value v = Value::fromString(t);
+			for (auto impl: {StructuralIndex::scalar, StructuralIndex::sse2, StructuralIndex::avx2}) {
+				Value w = IndexedParser(t, 0, impl).parse();
+				ok = ok && v == w && v.stringify() == w.stringify();
+			}
+			out << ok << " ";
+		}
+		StructuralIndex a, b;
+		a.build(gen, StructuralIndex::scalar);
+		b.build(gen);
+		out << (a.getOffsets() == b.getOffsets()) << " ";
+		IndexedParser p(" 1  \"two\"[3] ", Parser<StreamFromString>::packArrays);
+		Value x = p.parse(), y = p.parse(), z = p.parse();
+		out << (x.getUInt() == 1 && y.getString() == "two" && z[0].getUInt() == 3) << " ";
+		bool errs = true;
+		for (const char *bad: {"[1 2]", "{\"a\":1,}", "[12abc]", "{\"a\" 1}", "[\"abc\"x]", "[1,", "\"abc", "[tru]", "{\"a\":{\"b\":[1,]}}"}) {
+			std::string e1, e2;
+			try {Value::fromString(bad);} catch (const ParseError &e) {e1 = e.what();}
+			try {IndexedParser(bad).parse();} catch (const ParseError &e) {e2 = e.what();}
+			if (e1.empty() || e1 != e2) {
+				errs = false;
+				out << bad << ": " << e1 << " | " << e2 << " ";
+			}
+		}
+		out << errs << " " << (IndexedParser("{\"a\":[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16]}", Parser<StreamFromString>::packArrays).parse()["a"].flags() & packedNumbers ? 1 : 0);
+	};
+	tst.test("Serialize.shortestDouble","0.1 0.30000000000000004 10000000 1e+8 123.456 0.01 1e-3 -2.5e-10 5e-324 1.7976931348623157e+308 1") >> [](std::ostream &out) {
+		json::maxPrecisionDigits = json::shortestPrecision;
+		for (double d: {0.1, 0.1+0.2, 1e7, 1e8, 123.456, 0.01, 0.001, -2.5e-10, 5e-324, 1.7976931348623157e308}) {
+			out << Value(d).stringify() << " ";
+		}
+		std::mt19937_64 rnd(42);
+		bool roundTrip = true;
+		for (int i = 0; i < 100000; i++) {
+			std::uint64_t bits = rnd();
+			double d;
+			std::memcpy(&d, &bits, sizeof(d));
+			if (!std::isfinite(d)) continue;
+			double v = Value::fromString(Value(d).stringify()).getNumber();
+			roundTrip = roundTrip && v == d;
+		}
+		out << roundTrip;
+		json::maxPrecisionDigits = 4;
+	};
+	tst.test("Serialize.integers","[0,7,10,99,100,-1,-10,-99,-100,4294967295,-2147483648,18446744073709551615,-9223372036854775808,1700000000123]") >> [](std::ostream &out) {
+		out << Value(array, {0, 7, 10, 99, 100, -1, -10, -99, -100, 4294967295U, std::numeric_limits<int>::min(),
+				std::numeric_limits<ULongInt>::max(), std::numeric_limits<LongInt>::min(), 1700000000123LL}).stringify();
+	};
+
 //	runValidatorTests(tst);
 	runJwtTests(tst);
 	//runRpcTests(tst);
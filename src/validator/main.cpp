@@ -1,4 +1,5 @@
 #include <fstream>
+#include <iterator>
 #include "../imtjson/json.h"
 #include "../imtjson/validator.h"
 
@@ -16,9 +17,14 @@ static void printRej(std::ostream &out, Value path, Value rule) {
 	out << std::endl;
 }
 
+static Value readAll(std::istream &in) {
+	std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	return Value::fromString(text);
+}
+
 int runValidator(std::istream &indef, std::istream &in, std::ostream &errors) {
-	Value def = Value::fromStream(indef);
-	Value input = Value::fromStream(in);
+	Value def = readAll(indef);
+	Value input = readAll(in);
 	Validator v(def);
 	if (v.validate(input)) return 0;
 	Value rej = v.getRejections();